@@ -1,12 +1,174 @@
+#define _GNU_SOURCE
 #include "loader.h"
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
 
+// The loader runs payloads of its own word size: build with -m32 for ELF32
+// and natively for ELF64
+#if UINTPTR_MAX > 0xffffffff
+typedef Elf64_Ehdr elfHeader;
+typedef Elf64_Phdr progHeader;
+typedef Elf64_Addr elfAddr;
+#define NativeElfClass ELFCLASS64
+#else
 typedef Elf32_Ehdr elfHeader;
 typedef Elf32_Phdr progHeader;
+typedef Elf32_Addr elfAddr;
+#define NativeElfClass ELFCLASS32
+#endif
 
 #define SizeofPage 4096
+#define MinResidentBudget 4
+#define FaultAroundPages 16
 static int faults = 0;
-static int allocations = 0;
-static size_t intFragmentation = 0;
+static atomic_int allocations = 0;
+static atomic_size_t intFragmentation = 0;
+static atomic_size_t bytesRead = 0;
+static atomic_size_t bytesMapped = 0;
+
+// How pages get populated
+typedef enum { LOAD_LAZY, LOAD_FAULTAROUND, LOAD_FILEMAP, LOAD_EAGER } loadMode;
+static const char *loadModeNames[] = { "lazy", "faultaround", "filemap", "eager" };
+static loadMode mode = LOAD_LAZY;
+
+// Resident-set budget (0 = unlimited) and eviction statistics
+typedef enum { EVICT_CLOCK, EVICT_LRU } evictPolicy;
+static size_t residentBudget = 0;
+static int trackDirty = 0;
+static evictPolicy policy = EVICT_CLOCK;
+static int evictions = 0;
+static int refaults = 0;
+static int swapWrites = 0;
+static atomic_size_t residentPages = 0;
+static atomic_size_t peakResidentPages = 0;
+
+// Background prefetcher (depth 0 = disabled) and its statistics
+#define FaultRingSize 256
+#define MaxPrefetchStride 8
+static int prefetchDepth = 0;
+static atomic_int prefetchedPages = 0;
+static atomic_int faultsPrevented = 0;
+static atomic_int faultsHidden = 0;
+
+// Load once, run many: number of runs of the entry point
+static int iterations = 1;
+static int verbose = 1;
+
+// Result of one binary in batch mode, written by the child into shared memory
+typedef struct loadStats {
+    int faults;
+    int allocations;
+    size_t bytesRead;
+    int frameHits;
+    int frameMisses;
+    int evictions;
+    int refaults;
+    size_t fragmentation;
+    size_t peakResident;
+    int output;
+    int status;
+    int cached;
+    double ms;
+} loadStats;
+
+// Validated headers and segment index of one ELF, keyed by (inode, mtime, size)
+#define HeaderCacheBuckets 64
+typedef struct headerCache {
+    dev_t dev;
+    ino_t ino;
+    struct timespec mtime;
+    off_t size;
+    elfHeader *elfhdr;
+    progHeader *phdr;
+    int *loadSegs;
+    int loadCount;
+    size_t *segFirstPage;
+    size_t totalPages;
+    struct headerCache *next;
+} headerCache;
+
+static headerCache *headerCacheTable[HeaderCacheBuckets];
+
+// Read-only file pages shared by every load in this loader process (and its
+// batch children): frames live in a memfd, the index in a shared mapping
+typedef struct frameKey {
+    dev_t dev;
+    ino_t ino;
+    struct timespec mtime;
+    off_t offset;               // file offset of the first byte taken from the ELF
+    unsigned int lead;          // zero bytes before it in the page
+    unsigned int length;        // bytes taken from the ELF
+} frameKey;
+
+enum { FRAME_EMPTY, FRAME_FILLING, FRAME_READY };
+
+typedef struct frameSlot {
+    atomic_int state;
+    frameKey key;
+} frameSlot;
+
+typedef struct frameCache {
+    size_t capacity;
+    atomic_int hits;
+    atomic_int misses;
+    frameSlot slots[];
+} frameCache;
+
+static size_t frameCacheFrames = 0;
+static frameCache *frames = NULL;
+static int frameFd = -1;
+static struct stat elfStat;
+static atomic_int frameHits = 0;
+static atomic_int frameMisses = 0;
+
+// Book-keeping for every page covered by a PT_LOAD segment
+typedef struct pageInfo {
+    void *addr;                 // page aligned virtual address
+    int resident;               // currently backed by a frame
+    int loaded;                 // has been populated at least once
+    int referenced;             // accessed since the last sample
+    int sampled;                // mapped PROT_NONE to catch the next access
+    int dirty;                  // written since it was populated
+    int inSwap;                 // swap file holds the current contents
+    int prefetched;             // filled ahead of use by the prefetcher
+    atomic_int busy;            // claimed by whoever is changing residency
+    unsigned long lastUsed;     // LRU timestamp (sample epoch)
+} pageInfo;
+
+static pageInfo *pageTable = NULL;
+static size_t *segFirstPage = NULL;
+static int *loadSegs = NULL;
+static int loadCount = 0;
+static size_t totalPages = 0;
+static size_t clockHand = 0;
+static atomic_ulong useClock = 0;
+static size_t populationsSinceSample = 0;
+static int swapFd = -1;
+
+// Fault stream handed from the SIGSEGV handler to the prefetcher thread
+typedef struct faultEvent {
+    int segment;
+    size_t index;
+} faultEvent;
+
+// Per-segment access pattern seen by the prefetcher
+typedef struct streamInfo {
+    long lastIndex;
+    long stride;
+    int confirmed;
+} streamInfo;
+
+static faultEvent faultRing[FaultRingSize];
+static atomic_size_t faultHead = 0;
+static atomic_size_t faultTail = 0;
+static sem_t faultSignal;
+static atomic_int prefetchStop = 0;
+static pthread_t prefetchThread;
+static streamInfo *streams = NULL;
 
 // Global variables for ELF information
 static elfHeader *elfhdr = NULL;
@@ -28,6 +190,26 @@ void loader_cleanup() {
         close(fd);
         fd = -1;
     }
+    if (pageTable) {
+        free(pageTable);
+        pageTable = NULL;
+    }
+    if (segFirstPage) {
+        free(segFirstPage);
+        segFirstPage = NULL;
+    }
+    if (loadSegs) {
+        free(loadSegs);
+        loadSegs = NULL;
+    }
+    if (swapFd >= 0) {
+        close(swapFd);
+        swapFd = -1;
+    }
+    if (streams) {
+        free(streams);
+        streams = NULL;
+    }
 }
 
 //open elf in read-only mode
@@ -37,6 +219,10 @@ int open_elf(const char *file_path) {
         perror("Failed to open ELF file");
         return -1;
     }
+    if (fstat(fd, &elfStat) == -1) {
+        perror("Failed to stat ELF file");
+        return -1;
+    }
     return fd;
 }
 
@@ -79,13 +265,11 @@ void* getEntryPoint() {
 
 //segment corresponding to faulting address
 progHeader* find_segment(void *addr){
-    Elf32_Addr ad = (Elf32_Addr)addr;
-    for (int i = 0; i < elfhdr->e_phnum; i++) {
-        if (phdr[i].p_type == 1) {
-            Elf32_Addr s = phdr[i].p_vaddr;
-            if (ad >= s && ad < s + phdr[i].p_memsz){
-                return &phdr[i];
-            }
+    elfAddr ad = (elfAddr)addr;
+    for (int i = 0; i < loadCount; i++) {
+        elfAddr s = phdr[loadSegs[i]].p_vaddr;
+        if (ad >= s && ad < s + phdr[loadSegs[i]].p_memsz){
+            return &phdr[loadSegs[i]];
         }
     }
     return NULL;
@@ -118,7 +302,464 @@ size_t getFrag(progHeader *segment, void *addr) {
     return 0;
 }
 
+//reject anything we could not map with the header types above
+int validate_elf() {
+    if (memcmp(elfhdr->e_ident, ELFMAG, SELFMAG) != 0) {
+        printf("Invalid ELF file\n");
+        return -1;
+    }
+    if (elfhdr->e_ident[EI_CLASS] != NativeElfClass) {
+        printf("ELF class does not match the loader, build the loader with -m%d\n",
+               elfhdr->e_ident[EI_CLASS] == ELFCLASS64 ? 64 : 32);
+        return -1;
+    }
+    if (elfhdr->e_phentsize != sizeof(progHeader) || elfhdr->e_phnum == 0) {
+        printf("Unsupported program header layout\n");
+        return -1;
+    }
+    return 0;
+}
+
+//PT_LOAD segments and where each one starts in the page table
+int index_segments() {
+    segFirstPage = (size_t *)malloc(elfhdr->e_phnum * sizeof(size_t));
+    loadSegs = (int *)malloc(elfhdr->e_phnum * sizeof(int));
+    if (!segFirstPage || !loadSegs) {
+        perror("Memory allocation failed for segment index");
+        return -1;
+    }
+    totalPages = 0;
+    loadCount = 0;
+    for (int i = 0; i < elfhdr->e_phnum; i++) {
+        segFirstPage[i] = totalPages;
+        if (phdr[i].p_type == PT_LOAD) {
+            loadSegs[loadCount++] = i;
+            totalPages += getPages(&phdr[i]);
+        }
+    }
+    return 0;
+}
+
+int build_page_table() {
+    pageTable = (pageInfo *)calloc(totalPages ? totalPages : 1, sizeof(pageInfo));
+    if (!pageTable) {
+        perror("Memory allocation failed for page table");
+        return -1;
+    }
+    for (int l = 0; l < loadCount; l++) {
+        int i = loadSegs[l];
+        uintptr_t s_page = phdr[i].p_vaddr & ~(SizeofPage - 1);
+        for (size_t p = 0; p < getPages(&phdr[i]); p++) {
+            pageTable[segFirstPage[i] + p].addr = (void *)(s_page + p * SizeofPage);
+        }
+    }
+    return 0;
+}
+
+//segment owning a page table entry; the first page of a segment that does
+//not start on a page boundary lies below p_vaddr, so find_segment() cannot
+//be used with a page's address
+progHeader* segment_of_page(size_t index) {
+    for (int l = 0; l < loadCount; l++) {
+        int i = loadSegs[l];
+        if (index >= segFirstPage[i] && index < segFirstPage[i] + getPages(&phdr[i])) {
+            return &phdr[i];
+        }
+    }
+    return NULL;
+}
+
+pageInfo* find_page(progHeader *segment, void *addr) {
+    uintptr_t s_page = segment->p_vaddr & ~(SizeofPage - 1);
+    size_t index = ((uintptr_t)addr - s_page) / SizeofPage;
+    return &pageTable[segFirstPage[segment - phdr] + index];
+}
+
+//only the holder of a page's claim may change whether it is resident
+int claim_page(pageInfo *page) {
+    int expected = 0;
+    return atomic_compare_exchange_strong(&page->busy, &expected, 1);
+}
+
+void release_page(pageInfo *page) {
+    atomic_store_explicit(&page->busy, 0, memory_order_release);
+}
+
+//take one frame out of the resident budget, fails when the budget is used up
+int reserve_resident_page() {
+    size_t now = atomic_load(&residentPages);
+    do {
+        if (residentBudget > 0 && now >= residentBudget) return 0;
+    } while (!atomic_compare_exchange_weak(&residentPages, &now, now + 1));
+
+    size_t peak = atomic_load(&peakResidentPages);
+    while (now + 1 > peak && !atomic_compare_exchange_weak(&peakResidentPages, &peak, now + 1));
+    return 1;
+}
+
+//protection the segment asks for; writable pages stay read-only until
+//their first write when we have to know which pages are dirty
+int page_prot(progHeader *segment, pageInfo *page) {
+    int prot = 0;
+    if (segment->p_flags & PF_R) prot |= PROT_READ;
+    if (segment->p_flags & PF_W) prot |= PROT_WRITE;
+    if (segment->p_flags & PF_X) prot |= PROT_EXEC;
+    if (trackDirty && !page->dirty) prot &= ~PROT_WRITE;
+    return prot;
+}
+
+//part of a page that comes from the file: offset into the page, length and
+//file offset; length is 0 for pure bss pages
+size_t page_file_range(progHeader *segment, void *page, size_t *lead, off_t *fOffset) {
+    uintptr_t p_start = (uintptr_t)page;
+    uintptr_t f_start = segment->p_vaddr;
+    uintptr_t f_end = segment->p_vaddr + segment->p_filesz;
+    uintptr_t from = (p_start > f_start) ? p_start : f_start;
+    uintptr_t to = (p_start + SizeofPage < f_end) ? p_start + SizeofPage : f_end;
+
+    if (from >= to) return 0;
+    *lead = from - p_start;
+    *fOffset = segment->p_offset + (from - f_start);
+    return to - from;
+}
+
+//copy the file-backed part of a page, the rest stays zero (bss)
+size_t fill_page(progHeader *segment, void *page, void *dst) {
+    size_t lead = 0;
+    off_t fOffset = 0;
+    size_t rSize = page_file_range(segment, page, &lead, &fOffset);
+
+    memset(dst, 0, SizeofPage);
+    if (rSize == 0) return 0;
+
+    size_t bytes_read = 0;
+    while (bytes_read < rSize) {
+        ssize_t ret = pread(fd, (char *)dst + lead + bytes_read, rSize - bytes_read, fOffset + bytes_read);
+        if (ret <= 0) {
+            if (ret == 0) break;
+            perror("Read failed");
+            exit(EXIT_FAILURE);
+        }
+        bytes_read += ret;
+    }
+    bytesRead += bytes_read;
+    return bytes_read;
+}
+
+//swap file lives in TMPDIR and is unlinked right away, every page has a fixed slot
+int open_swap() {
+    const char *dir = getenv("TMPDIR");
+    char path[512];
+    snprintf(path, sizeof(path), "%s/loader-swap-XXXXXX", dir ? dir : "/tmp");
+    swapFd = mkstemp(path);
+    if (swapFd < 0) {
+        perror("Failed to create swap file");
+        return -1;
+    }
+    unlink(path);
+    return 0;
+}
+
+void evict_page(pageInfo *page) {
+    if (page->dirty) {
+        if (swapFd < 0 && open_swap() < 0) {
+            exit(EXIT_FAILURE);
+        }
+        off_t slot = (off_t)(page - pageTable) * SizeofPage;
+        if (page->sampled && mprotect(page->addr, SizeofPage, PROT_READ) == -1) {
+            perror("Failed to unprotect page for swap out");
+            exit(EXIT_FAILURE);
+        }
+        if (pwrite(swapFd, page->addr, SizeofPage, slot) != SizeofPage) {
+            perror("Failed to write page to swap");
+            exit(EXIT_FAILURE);
+        }
+        page->inSwap = 1;
+        swapWrites++;
+    }
+
+    //drop the frame but keep the address range reserved for the refault
+    if (mmap(page->addr, SizeofPage, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED) {
+        perror("Failed to evict page");
+        exit(EXIT_FAILURE);
+    }
+    page->resident = 0;
+    page->referenced = 0;
+    page->sampled = 0;
+    page->dirty = 0;
+    atomic_fetch_sub(&residentPages, 1);
+    evictions++;
+}
+
+//revoke access so that the next touch of the page shows up as a fault
+void sample_page(pageInfo *page) {
+    if (page->sampled) return;
+    if (mprotect(page->addr, SizeofPage, PROT_NONE) == -1) {
+        perror("Failed to sample page");
+        exit(EXIT_FAILURE);
+    }
+    page->sampled = 1;
+    page->referenced = 0;
+}
+
+pageInfo* pick_victim() {
+    if (policy == EVICT_CLOCK) {
+        //second chance: referenced pages get sampled and skipped once
+        for (;;) {
+            pageInfo *page = &pageTable[clockHand];
+            clockHand = (clockHand + 1) % totalPages;
+            if (!page->resident) continue;
+            if (page->referenced) {
+                sample_page(page);
+                continue;
+            }
+            if (!claim_page(page)) continue;
+            return page;
+        }
+    }
+
+    for (;;) {
+        pageInfo *victim = NULL;
+        for (size_t i = 0; i < totalPages; i++) {
+            pageInfo *page = &pageTable[i];
+            if (page->resident && (!victim || page->lastUsed < victim->lastUsed)) {
+                victim = page;
+            }
+        }
+        if (claim_page(victim)) return victim;
+    }
+}
+
+//LRU only learns about accesses through faults, so sample every resident
+//page once per budget worth of populations
+void lru_sample_epoch() {
+    if (policy != EVICT_LRU || ++populationsSinceSample < residentBudget) return;
+    populationsSinceSample = 0;
+    for (size_t i = 0; i < totalPages; i++) {
+        if (pageTable[i].resident) sample_page(&pageTable[i]);
+    }
+}
+
+//fault on a page we already hold: a sampled access or the first write
+int handle_resident_fault(progHeader *segment, pageInfo *page) {
+    if (page->sampled) {
+        page->sampled = 0;
+        page->referenced = 1;
+        page->lastUsed = ++useClock;
+    } else if ((segment->p_flags & PF_W) && !page->dirty) {
+        page->dirty = 1;
+    } else {
+        return -1;
+    }
+    if (mprotect(page->addr, SizeofPage, page_prot(segment, page)) == -1) {
+        perror("Failed to restore page permissions");
+        exit(EXIT_FAILURE);
+    }
+    return 0;
+}
+
+//contents of a page, from swap if it was evicted dirty, otherwise from the ELF
+size_t load_frame(progHeader *segment, pageInfo *page, void *frame) {
+    if (page->inSwap) {
+        if (pread(swapFd, frame, SizeofPage, (off_t)(page - pageTable) * SizeofPage) != SizeofPage) {
+            perror("Failed to read page from swap");
+            exit(EXIT_FAILURE);
+        }
+        return SizeofPage;
+    }
+    return fill_page(segment, page->addr, frame);
+}
+
+void mark_resident(progHeader *segment, pageInfo *page) {
+    if (!page->loaded) {
+        intFragmentation += getFrag(segment, page->addr);
+    }
+    page->resident = 1;
+    page->loaded = 1;
+    page->referenced = 1;
+    page->dirty = 0;
+    page->lastUsed = ++useClock;
+}
+
+//file offset of a page that lies entirely in the file image at a page
+//aligned offset, so it can be mapped from the ELF directly
+int file_backed_offset(progHeader *segment, pageInfo *page, off_t *offset) {
+    uintptr_t p_start = (uintptr_t)page->addr;
+    if (page->inSwap || (segment->p_offset - segment->p_vaddr) % SizeofPage != 0) return 0;
+    if (p_start < segment->p_vaddr || p_start + SizeofPage > segment->p_vaddr + segment->p_filesz) return 0;
+    *offset = segment->p_offset + (p_start - segment->p_vaddr);
+    return 1;
+}
+
+int open_frame_cache() {
+    size_t size = sizeof(frameCache) + frameCacheFrames * sizeof(frameSlot);
+    frames = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (frames == MAP_FAILED) {
+        perror("Failed to map frame cache index");
+        return -1;
+    }
+    frames->capacity = frameCacheFrames;
+    frameFd = memfd_create("loader-frames", 0);
+    if (frameFd < 0 || ftruncate(frameFd, (off_t)frameCacheFrames * SizeofPage) == -1) {
+        perror("Failed to create frame cache");
+        return -1;
+    }
+    return 0;
+}
+
+int same_frame(frameKey *a, frameKey *b) {
+    return a->dev == b->dev && a->ino == b->ino && a->offset == b->offset &&
+           a->lead == b->lead && a->length == b->length &&
+           a->mtime.tv_sec == b->mtime.tv_sec && a->mtime.tv_nsec == b->mtime.tv_nsec;
+}
+
+//find the frame holding this content or claim an empty one to fill, -1 when full
+long frame_lookup(frameKey *key, int *fill) {
+    size_t h = (size_t)key->ino * 31 + (size_t)key->offset * 17 + key->lead * 7 + key->length;
+    for (size_t probe = 0; probe < frames->capacity; probe++) {
+        size_t i = (h + probe) % frames->capacity;
+        frameSlot *slot = &frames->slots[i];
+        int state = atomic_load_explicit(&slot->state, memory_order_acquire);
+        if (state == FRAME_EMPTY) {
+            if (atomic_compare_exchange_strong(&slot->state, &state, FRAME_FILLING)) {
+                slot->key = *key;
+                *fill = 1;
+                return i;
+            }
+        }
+        while (state == FRAME_FILLING) {
+            sched_yield();
+            state = atomic_load_explicit(&slot->state, memory_order_acquire);
+        }
+        if (same_frame(&slot->key, key)) {
+            *fill = 0;
+            return i;
+        }
+    }
+    return -1;
+}
+
+//map a read-only page from the shared frame cache, filling the frame from
+//the ELF on a miss; returns 0 when the page is not cacheable
+int map_cached_frame(progHeader *segment, pageInfo *page, size_t *rSize) {
+    frameKey key;
+    size_t lead = 0;
+    memset(&key, 0, sizeof(key));
+    key.length = page_file_range(segment, page->addr, &lead, &key.offset);
+    if (key.length == 0) return 0;
+    key.lead = lead;
+    key.dev = elfStat.st_dev;
+    key.ino = elfStat.st_ino;
+    key.mtime = elfStat.st_mtim;
+
+    int fill = 0;
+    long slot = frame_lookup(&key, &fill);
+    if (slot < 0) return 0;
+
+    *rSize = 0;
+    if (fill) {
+        char buffer[SizeofPage];
+        *rSize = fill_page(segment, page->addr, buffer);
+        if (pwrite(frameFd, buffer, SizeofPage, (off_t)slot * SizeofPage) != SizeofPage) {
+            perror("Failed to fill frame cache");
+            exit(EXIT_FAILURE);
+        }
+        atomic_store_explicit(&frames->slots[slot].state, FRAME_READY, memory_order_release);
+        frames->misses++;
+        frameMisses++;
+    } else {
+        frames->hits++;
+        frameHits++;
+    }
+
+    mark_resident(segment, page);
+    if (mmap(page->addr, SizeofPage, page_prot(segment, page), MAP_SHARED | MAP_FIXED, frameFd, (off_t)slot * SizeofPage) == MAP_FAILED) {
+        perror("Failed to map cached frame");
+        exit(EXIT_FAILURE);
+    }
+    return 1;
+}
+
+//back a claimed page that already has a reserved frame, returns bytes read
+size_t populate_page(progHeader *segment, pageInfo *page) {
+    off_t offset;
+    size_t rSize = 0;
+
+    allocations++;
+    if (mode == LOAD_FILEMAP && file_backed_offset(segment, page, &offset)) {
+        mark_resident(segment, page);
+        if (mmap(page->addr, SizeofPage, page_prot(segment, page), MAP_PRIVATE | MAP_FIXED, fd, offset) == MAP_FAILED) {
+            perror("Failed to map segment from file");
+            exit(EXIT_FAILURE);
+        }
+        bytesMapped += SizeofPage;
+        return 0;
+    }
+    if (frames && !(segment->p_flags & PF_W) && !page->inSwap && map_cached_frame(segment, page, &rSize)) {
+        return rSize;
+    }
+    
+    void *Mapping = mmap(page->addr, SizeofPage, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+    
+    if (Mapping == MAP_FAILED) {
+        perror("Failed to map memory for segment");
+        exit(EXIT_FAILURE);
+    }
+
+    rSize = load_frame(segment, page, Mapping);
+    mark_resident(segment, page);
+
+    if (mprotect(Mapping, SizeofPage, page_prot(segment, page)) == -1) {
+        perror("Failed to set segment permissions");
+        munmap(Mapping, SizeofPage);
+        exit(EXIT_FAILURE);
+    }
+    return rSize;
+}
+
+//populate a free page if it is unclaimed and fits in the budget, never evicts
+void populate_if_free(progHeader *segment, pageInfo *page) {
+    if (page->resident || !claim_page(page)) return;
+    if (!page->resident && reserve_resident_page()) {
+        populate_page(segment, page);
+    }
+    release_page(page);
+}
+
+//map the aligned window of pages around a fault in the same segment
+void fault_around(progHeader *segment, pageInfo *page) {
+    pageInfo *pages = &pageTable[segFirstPage[segment - phdr]];
+    size_t count = getPages(segment);
+    size_t first = ((page - pages) / FaultAroundPages) * FaultAroundPages;
+    for (size_t i = first; i < first + FaultAroundPages && i < count; i++) {
+        if (&pages[i] != page) populate_if_free(segment, &pages[i]);
+    }
+}
+
+//eager mode: everything up front, as far as the budget allows
+void populate_all() {
+    for (int l = 0; l < loadCount; l++) {
+        progHeader *segment = &phdr[loadSegs[l]];
+        pageInfo *pages = &pageTable[segFirstPage[loadSegs[l]]];
+        for (size_t i = 0; i < getPages(segment); i++) {
+            populate_if_free(segment, &pages[i]);
+        }
+    }
+}
+
+//hand a population fault to the prefetcher, dropped when the ring is full
+void post_fault(progHeader *segment, pageInfo *page) {
+    if (prefetchDepth == 0) return;
+    size_t head = atomic_load_explicit(&faultHead, memory_order_relaxed);
+    if (head - atomic_load_explicit(&faultTail, memory_order_acquire) >= FaultRingSize) return;
+    faultRing[head % FaultRingSize].segment = segment - phdr;
+    faultRing[head % FaultRingSize].index = (page - pageTable) - segFirstPage[segment - phdr];
+    atomic_store_explicit(&faultHead, head + 1, memory_order_release);
+    sem_post(&faultSignal);
+}
+
 void SIGSEGV_handler( int sig, siginfo_t *info, void *context ) {
+    static pageInfo *unexplained = NULL;
     void *fault_addr = info->si_addr;
     faults++;
     
@@ -129,61 +770,184 @@ void SIGSEGV_handler( int sig, siginfo_t *info, void *context ) {
         printf("No segment found for the given fault address.");
         exit(EXIT_FAILURE);
     }
-    size_t seg_offset = (uintptr_t)AdjustedAddress - segment->p_vaddr;
-    
-    void *Mapping = mmap(AdjustedAddress, SizeofPage, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
-    
-    if (Mapping == MAP_FAILED) {
-        perror("Failed to map memory for segment");
+    pageInfo *page = find_page(segment, AdjustedAddress);
+
+    if (!claim_page(page)) {
+        //the prefetcher is filling this page, wait for it and retry
+        while (atomic_load_explicit(&page->busy, memory_order_acquire)) {
+            sched_yield();
+        }
+        faultsHidden++;
+        return;
+    }
+
+    if (page->resident) {
+        int handled = handle_resident_fault(segment, page);
+        release_page(page);
+        if (handled == 0) {
+            unexplained = NULL;
+            return;
+        }
+        //the prefetcher may have mapped the page after we faulted, so only a
+        //second fault on the same page is a real access violation
+        if (prefetchDepth > 0 && unexplained != page) {
+            unexplained = page;
+            faultsHidden++;
+            return;
+        }
+        printf("Segmentation fault at %p\n", fault_addr);
+        exit(EXIT_FAILURE);
+    }
+    unexplained = NULL;
+
+    while (!reserve_resident_page()) {
+        pageInfo *victim = pick_victim();
+        evict_page(victim);
+        release_page(victim);
+    }
+    if (page->loaded) {
+        refaults++;
+    } else if (verbose) {
+        printf("Page fragmentation = %zd\n", getFrag(segment, AdjustedAddress));
+    }
+
+    size_t rSize = populate_page(segment, page);
+    if (verbose) printf("Read Size = %zd\n", rSize);
+    release_page(page);
+    if (mode == LOAD_FAULTAROUND) fault_around(segment, page);
+    post_fault(segment, page);
+    if (residentBudget > 0) lru_sample_epoch();
+}
+
+//fill a page off to the side and move it into place in one step, so the
+//program never sees it half written
+void prefetch_page(progHeader *segment, pageInfo *page) {
+    if (page->resident) return;
+    if (!claim_page(page)) return;
+    if (page->resident || !reserve_resident_page()) {
+        release_page(page);
+        return;
+    }
+
+    void *frame = mmap(NULL, SizeofPage, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (frame == MAP_FAILED) {
+        atomic_fetch_sub(&residentPages, 1);
+        release_page(page);
+        return;
+    }
+    load_frame(segment, page, frame);
+    mark_resident(segment, page);
+    if (mprotect(frame, SizeofPage, page_prot(segment, page)) == -1 ||
+        mremap(frame, SizeofPage, SizeofPage, MREMAP_MAYMOVE | MREMAP_FIXED, page->addr) == MAP_FAILED) {
+        perror("Failed to install prefetched page");
         exit(EXIT_FAILURE);
     }
-    
     allocations++;
+    prefetchedPages++;
+    page->prefetched = 1;
+    release_page(page);
+}
 
-    off_t fOffset = segment->p_offset + seg_offset;
-    size_t remBytes = (segment->p_memsz > seg_offset) ? (segment->p_memsz - seg_offset) : 0;
-    size_t rSize = (remBytes < SizeofPage) ? remBytes : SizeofPage;
-    
-    printf("Remaining bytes = %zd\n", remBytes);
-    printf("Read Size = %zd\n", rSize);
-    
-    memset(Mapping,0,SizeofPage);
-    if (rSize > 0) {
-        if (lseek(fd, fOffset, SEEK_SET) == -1) {
-            perror("Failed to locate in file");
-            munmap(Mapping, SizeofPage);
-            exit(EXIT_FAILURE);
-        }
+//detect sequential or strided faults in a segment and run ahead of them
+void observe_fault(faultEvent *event) {
+    progHeader *segment = &phdr[event->segment];
+    streamInfo *stream = &streams[event->segment];
+    pageInfo *pages = &pageTable[segFirstPage[event->segment]];
+    long index = (long)event->index;
+    long step = index - stream->lastIndex;
 
-        size_t bytes_read = 0;
-        while (bytes_read < rSize) {
-            ssize_t ret = read(fd, Mapping + bytes_read, rSize - bytes_read);
-            if (ret <= 0) {
-                if (ret == 0) break; 
-                perror("Read failed");
-                munmap(Mapping, SizeofPage);
-                exit(EXIT_FAILURE);
+    if (stream->confirmed && step != 0 && (step > 0) == (stream->stride > 0) && step % stream->stride == 0) {
+        //the program moved past the pages we filled without faulting on them
+        for (long i = stream->lastIndex + stream->stride; i != index; i += stream->stride) {
+            if (pages[i].prefetched) {
+                pages[i].prefetched = 0;
+                faultsPrevented++;
             }
-            bytes_read += ret;
         }
+    } else {
+        stream->confirmed = (step != 0 && step == stream->stride && labs(step) <= MaxPrefetchStride);
+        stream->stride = step;
     }
-    size_t page_fragmentation = getFrag(segment, AdjustedAddress);
-    intFragmentation += page_fragmentation;
-    printf("Page fragmentation = %zd\n", page_fragmentation);
+    stream->lastIndex = index;
 
-    if (rSize < SizeofPage) {
-        memset(Mapping + rSize, 0, SizeofPage - rSize);
+    if (!stream->confirmed) return;
+    long count = (long)getPages(segment);
+    for (int k = 1; k <= prefetchDepth; k++) {
+        long next = index + stream->stride * k;
+        if (next < 0 || next >= count) break;
+        prefetch_page(segment, &pages[next]);
     }
-    int prot = 0;
-    if (segment->p_flags & PF_R) prot |= PROT_READ;
-    if (segment->p_flags & PF_W) prot |= PROT_WRITE;
-    if (segment->p_flags & PF_X) prot |= PROT_EXEC;
+}
 
-    if (mprotect(Mapping, SizeofPage, prot) == -1) {
-        perror("Failed to set segment permissions");
-        munmap(Mapping, SizeofPage);
-        exit(EXIT_FAILURE);
+void* prefetcher(void *arg) {
+    for (;;) {
+        while (sem_wait(&faultSignal) == -1);
+        size_t tail = atomic_load_explicit(&faultTail, memory_order_relaxed);
+        size_t head = atomic_load_explicit(&faultHead, memory_order_acquire);
+        if (tail == head && atomic_load(&prefetchStop)) break;
+        for (; tail != head; tail++) {
+            faultEvent event = faultRing[tail % FaultRingSize];
+            atomic_store_explicit(&faultTail, tail + 1, memory_order_release);
+            observe_fault(&event);
+        }
+    }
+    return NULL;
+}
+
+int start_prefetcher() {
+    streams = (streamInfo *)calloc(elfhdr->e_phnum, sizeof(streamInfo));
+    if (!streams) {
+        perror("Memory allocation failed for prefetch streams");
+        return -1;
+    }
+    for (int i = 0; i < elfhdr->e_phnum; i++) {
+        streams[i].lastIndex = -1;
     }
+    sem_init(&faultSignal, 0, 0);
+    if (pthread_create(&prefetchThread, NULL, prefetcher, NULL) != 0) {
+        perror("Failed to start prefetch thread");
+        return -1;
+    }
+    return 0;
+}
+
+void stop_prefetcher() {
+    atomic_store(&prefetchStop, 1);
+    sem_post(&faultSignal);
+    pthread_join(prefetchThread, NULL);
+    sem_destroy(&faultSignal);
+}
+
+//bring every page the last run wrote back to its pristine contents; pages
+//that were only read stay mapped for the next run
+int reset_written_pages() {
+    int reset = 0;
+    for (size_t i = 0; i < totalPages; i++) {
+        pageInfo *page = &pageTable[i];
+        if (!page->dirty && !page->inSwap) continue;
+        while (!claim_page(page));
+
+        if (page->resident) {
+            progHeader *segment = segment_of_page(i);
+            if (mprotect(page->addr, SizeofPage, PROT_READ | PROT_WRITE) == -1) {
+                perror("Failed to unprotect page for reset");
+                exit(EXIT_FAILURE);
+            }
+            page->inSwap = 0;
+            page->dirty = 0;
+            page->sampled = 0;
+            fill_page(segment, page->addr, page->addr);
+            if (mprotect(page->addr, SizeofPage, page_prot(segment, page)) == -1) {
+                perror("Failed to protect reset page");
+                exit(EXIT_FAILURE);
+            }
+        }
+        //an evicted page simply refaults from the ELF once its swap copy is gone
+        page->inSwap = 0;
+        release_page(page);
+        reset++;
+    }
+    return reset;
 }
 
 void setup_sigsegv_handler() {
@@ -199,44 +963,364 @@ void setup_sigsegv_handler() {
     }
 }
 
-void load_and_run_elf(const char *filename) {
-    setup_sigsegv_handler();
-    
-    if (open_elf(filename) < 0 || load_and_read_elfhdr() < 0 || load_and_read_phdr() < 0) {
+//call the entry point once per requested run, resetting written pages in between
+int run_entry() {
+    void (*start_func)(void) = getEntryPoint();
+    if (!start_func) {
+        fprintf(stderr, "Failed to find entry point\n");
         loader_cleanup();
         exit(EXIT_FAILURE);
     }
-    
-    if (memcmp(elfhdr->e_ident, ELFMAG, SELFMAG) != 0) {
-        printf("Invalid ELF file\n");
+
+    if (prefetchDepth > 0 && start_prefetcher() < 0) {
         loader_cleanup();
         exit(EXIT_FAILURE);
     }
+    if (mode == LOAD_EAGER) populate_all();
     
-    void (*start_func)(void) = getEntryPoint();
-    if (!start_func) {
-        fprintf(stderr, "Failed to find entry point\n");
-        loader_cleanup();
-        exit(EXIT_FAILURE);
+    int return_value = 0;
+    for (int run = 1; run <= iterations; run++) {
+        struct timespec start, finish;
+        int faultsBefore = faults;
+        int pagesReset = 0;
+
+        if (run > 1) pagesReset = reset_written_pages();
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        return_value = ((int (*)(void))start_func)();
+        clock_gettime(CLOCK_MONOTONIC, &finish);
+
+        if (verbose && iterations > 1) {
+            double ms = (finish.tv_sec - start.tv_sec) * 1000.0 + (finish.tv_nsec - start.tv_nsec) / 1e6;
+            printf("Run %d: %.3f ms, page faults %d, pages reset %d, output %d\n",
+                   run, ms, faults - faultsBefore, pagesReset, return_value);
+        }
     }
-    
-    int return_value = ((int (*)(void))start_func)();
+
+    if (prefetchDepth > 0) stop_prefetcher();
+    return return_value;
+}
+
+void print_statistics(int return_value) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
     
     printf("Execution Statistics:\n");
     printf("Page faults: %d\n", faults);
     printf("Page allocations: %d\n", allocations);
     printf("Internal Fragmentation: %.2f KB\n", intFragmentation / 1024.0);
+    printf("Load mode: %s\n", loadModeNames[mode]);
+    printf("Bytes read: %zu\n", (size_t)bytesRead);
+    printf("Bytes mapped from file: %zu\n", (size_t)bytesMapped);
+    if (frames) {
+        printf("Frame cache: %d pages served from cache, %d read from disk\n", frameHits, frameMisses);
+    }
+    if (prefetchDepth > 0) {
+        printf("Prefetched pages: %d (depth %d)\n", prefetchedPages, prefetchDepth);
+        printf("Faults prevented by prefetch: %d\n", faultsPrevented);
+        printf("Faults hidden by in-flight prefetch: %d\n", faultsHidden);
+    }
+    if (residentBudget > 0) {
+        printf("Resident budget: %zu pages (%s)\n", residentBudget, policy == EVICT_CLOCK ? "clock" : "lru");
+        printf("Evictions: %d\n", evictions);
+        printf("Refaults: %d\n", refaults);
+        printf("Swap writes: %d\n", swapWrites);
+    }
+    printf("Peak resident pages: %zu (%.2f KB)\n", (size_t)peakResidentPages, peakResidentPages * SizeofPage / 1024.0);
+    printf("Peak RSS: %ld KB\n", usage.ru_maxrss);
     printf("Program's Output: %d\n", return_value);
+}
+
+void load_and_run_elf(const char *filename) {
+    setup_sigsegv_handler();
+    
+    if (open_elf(filename) < 0 || load_and_read_elfhdr() < 0 || load_and_read_phdr() < 0) {
+        loader_cleanup();
+        exit(EXIT_FAILURE);
+    }
+    
+    if (validate_elf() < 0 || index_segments() < 0 || build_page_table() < 0) {
+        loader_cleanup();
+        exit(EXIT_FAILURE);
+    }
+
+    int return_value = run_entry();
+    print_statistics(return_value);
     
     loader_cleanup();
 }
 
+headerCache** header_cache_bucket(struct stat *st) {
+    return &headerCacheTable[(st->st_ino ^ st->st_size ^ st->st_mtim.tv_sec) % HeaderCacheBuckets];
+}
+
+headerCache* header_cache_lookup(struct stat *st) {
+    for (headerCache *entry = *header_cache_bucket(st); entry; entry = entry->next) {
+        if (entry->dev == st->st_dev && entry->ino == st->st_ino && entry->size == st->st_size &&
+            entry->mtime.tv_sec == st->st_mtim.tv_sec && entry->mtime.tv_nsec == st->st_mtim.tv_nsec) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+//read, validate and index the headers once, then keep them for later loads
+headerCache* header_cache_insert(const char *path, struct stat *st) {
+    headerCache *entry = (headerCache *)calloc(1, sizeof(headerCache));
+    if (!entry) {
+        perror("Memory allocation failed for header cache");
+        return NULL;
+    }
+    if (open_elf(path) < 0 || load_and_read_elfhdr() < 0 || load_and_read_phdr() < 0 ||
+        validate_elf() < 0 || index_segments() < 0) {
+        loader_cleanup();
+        free(entry);
+        return NULL;
+    }
+    close(fd);
+    fd = -1;
+
+    entry->dev = st->st_dev;
+    entry->ino = st->st_ino;
+    entry->mtime = st->st_mtim;
+    entry->size = st->st_size;
+    entry->elfhdr = elfhdr;
+    entry->phdr = phdr;
+    entry->loadSegs = loadSegs;
+    entry->loadCount = loadCount;
+    entry->segFirstPage = segFirstPage;
+    entry->totalPages = totalPages;
+    elfhdr = NULL;
+    phdr = NULL;
+    loadSegs = NULL;
+    segFirstPage = NULL;
+
+    headerCache **bucket = header_cache_bucket(st);
+    entry->next = *bucket;
+    *bucket = entry;
+    return entry;
+}
+
+//runs in the forked child, so the fault handler state starts out clean
+void run_cached_elf(const char *path, headerCache *entry, loadStats *stats) {
+    struct timespec start, finish;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    verbose = 0;
+    setup_sigsegv_handler();
+    elfhdr = entry->elfhdr;
+    phdr = entry->phdr;
+    loadSegs = entry->loadSegs;
+    loadCount = entry->loadCount;
+    segFirstPage = entry->segFirstPage;
+    totalPages = entry->totalPages;
+    if (open_elf(path) < 0 || build_page_table() < 0) {
+        _exit(EXIT_FAILURE);
+    }
+
+    stats->output = run_entry();
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+
+    stats->faults = faults;
+    stats->allocations = allocations;
+    stats->bytesRead = bytesRead;
+    stats->frameHits = frameHits;
+    stats->frameMisses = frameMisses;
+    stats->evictions = evictions;
+    stats->refaults = refaults;
+    stats->fragmentation = intFragmentation;
+    stats->peakResident = peakResidentPages;
+    stats->ms = (finish.tv_sec - start.tv_sec) * 1000.0 + (finish.tv_nsec - start.tv_nsec) / 1e6;
+    fflush(stdout);
+    _exit(EXIT_SUCCESS);
+}
+
+void run_batch(char **paths, int count) {
+    loadStats *stats = mmap(NULL, count * sizeof(loadStats), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (stats == MAP_FAILED) {
+        perror("Failed to map batch statistics");
+        exit(EXIT_FAILURE);
+    }
+    memset(stats, 0, count * sizeof(loadStats));
+
+    struct timespec start, finish;
+    int loaded = 0, hits = 0, misses = 0, unreadable = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < count; i++) {
+        struct stat st;
+        stats[i].status = -1;
+        if (stat(paths[i], &st) == -1) {
+            //never reaches the header cache, so it is neither a hit nor a miss
+            perror(paths[i]);
+            unreadable++;
+            continue;
+        }
+        headerCache *entry = header_cache_lookup(&st);
+        if (entry) {
+            stats[i].cached = 1;
+            hits++;
+        } else {
+            misses++;
+            if (!(entry = header_cache_insert(paths[i], &st))) continue;
+        }
+
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("Failed to fork loader");
+            continue;
+        }
+        if (pid == 0) {
+            run_cached_elf(paths[i], entry, &stats[i]);
+        }
+        int status;
+        waitpid(pid, &status, 0);
+        stats[i].status = status;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) loaded++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+    double seconds = (finish.tv_sec - start.tv_sec) + (finish.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("Batch Statistics:\n");
+    printf("%-32s %8s %8s %8s %8s %10s %10s %10s %8s %10s %10s\n", "Binary", "Faults", "Allocs", "Evict", "Refault", "Read(KB)", "Frag(KB)", "Time(ms)", "Cached", "Frames", "Output");
+    for (int i = 0; i < count; i++) {
+        if (!WIFEXITED(stats[i].status) || WEXITSTATUS(stats[i].status) != 0) {
+            printf("%-32s failed\n", paths[i]);
+            continue;
+        }
+        char frameColumn[32];
+        snprintf(frameColumn, sizeof(frameColumn), "%d/%d", stats[i].frameHits, stats[i].frameHits + stats[i].frameMisses);
+        printf("%-32s %8d %8d %8d %8d %10.2f %10.2f %10.3f %8s %10s %10d\n", paths[i], stats[i].faults, stats[i].allocations,
+               stats[i].evictions, stats[i].refaults, stats[i].bytesRead / 1024.0, stats[i].fragmentation / 1024.0, stats[i].ms,
+               stats[i].cached ? "yes" : "no", frames ? frameColumn : "-", stats[i].output);
+    }
+    printf("Loaded %d of %d binaries in %.3f s (%.1f loads/s)\n", loaded, count, seconds, seconds > 0 ? loaded / seconds : 0.0);
+    printf("Header cache: %d hits, %d misses\n", hits, misses);
+    if (unreadable > 0) {
+        printf("Errors: %d binaries could not be found or accessed\n", unreadable);
+    }
+    if (frames) {
+        printf("Frame cache: %d pages served from cache, %d read from disk\n", frames->hits, frames->misses);
+    }
+    munmap(stats, count * sizeof(loadStats));
+}
+
+//one executable per line, blank lines and # comments are skipped
+char** read_manifest(const char *manifest, int *count) {
+    FILE *file = fopen(manifest, "r");
+    if (!file) {
+        perror("Failed to open manifest");
+        return NULL;
+    }
+    int capacity = 16;
+    char **paths = malloc(capacity * sizeof(char *));
+    char *line = NULL;
+    size_t len = 0;
+    *count = 0;
+    while (getline(&line, &len, file) != -1) {
+        char *path = strtok(line, " \t\r\n");
+        if (!path || path[0] == '#') continue;
+        if (*count == capacity) {
+            capacity *= 2;
+            paths = realloc(paths, capacity * sizeof(char *));
+        }
+        paths[(*count)++] = strdup(path);
+    }
+    free(line);
+    fclose(file);
+    return paths;
+}
+
+void usage(const char *prog) {
+    printf("Usage: %s [-q] [-M lazy|faultaround|filemap|eager] [-r resident_pages] [-e clock|lru]\n"
+           "       [-p prefetch_depth] [-n runs] [-c cached_frames] <ELF Executable>...\n", prog);
+    printf("       %s [options] -m <manifest>\n", prog);
+}
+
 int main(int argc, char **argv) {
-    if (argc != 2) {
+    int opt;
+    const char *manifest = NULL;
+    while ((opt = getopt(argc, argv, "qM:r:e:p:n:m:c:")) != -1) {
+        switch (opt) {
+        case 'r':
+            residentBudget = strtoul(optarg, NULL, 10);
+            if (residentBudget > 0 && residentBudget < MinResidentBudget) {
+                printf("Resident budget must be at least %d pages\n", MinResidentBudget);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'e':
+            if (strcmp(optarg, "clock") == 0) {
+                policy = EVICT_CLOCK;
+            } else if (strcmp(optarg, "lru") == 0) {
+                policy = EVICT_LRU;
+            } else {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'p':
+            prefetchDepth = atoi(optarg);
+            if (prefetchDepth < 0) {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'm':
+            manifest = optarg;
+            break;
+        case 'q':
+            verbose = 0;
+            break;
+        case 'c':
+            frameCacheFrames = strtoul(optarg, NULL, 10);
+            break;
+        case 'M': {
+            int found = 0;
+            for (int i = 0; i <= LOAD_EAGER; i++) {
+                if (strcmp(optarg, loadModeNames[i]) == 0) {
+                    mode = (loadMode)i;
+                    found = 1;
+                }
+            }
+            if (!found) {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        }
+        case 'n':
+            iterations = atoi(optarg);
+            if (iterations < 1) {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    trackDirty = residentBudget > 0 || iterations > 1;
+    if (frameCacheFrames > 0 && open_frame_cache() < 0) {
+        return EXIT_FAILURE;
+    }
+
+    if (manifest) {
+        int count = 0;
+        char **paths = read_manifest(manifest, &count);
+        if (!paths) return EXIT_FAILURE;
+        run_batch(paths, count);
+        return 0;
+    }
+    if (optind == argc) {
         printf("Error. Exiting file.");
         return EXIT_FAILURE;
     }
+    if (optind < argc - 1) {
+        run_batch(&argv[optind], argc - optind);
+        return 0;
+    }
     
-    load_and_run_elf(argv[1]);
+    load_and_run_elf(argv[optind]);
     return 0;
 }
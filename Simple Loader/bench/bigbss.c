@@ -0,0 +1,14 @@
+// Large zero-initialised segment: almost nothing comes from the file
+#define BSS_SIZE (4 * 1024 * 1024)
+
+static char buffer[BSS_SIZE];
+
+int _start() {
+    volatile char *p = buffer;
+    int sum = 0;
+    for (int i = 0; i < BSS_SIZE; i += 4096) {
+        p[i] = (char)(i >> 12);
+        sum += p[i];
+    }
+    return sum;
+}
@@ -0,0 +1,10 @@
+// Sixteen small data segments (see manyseg.ld), each touched once
+#define SEG(n) __attribute__((section(".seg" #n))) int seg##n[64] = { n + 1 };
+
+SEG(0) SEG(1) SEG(2) SEG(3) SEG(4) SEG(5) SEG(6) SEG(7)
+SEG(8) SEG(9) SEG(10) SEG(11) SEG(12) SEG(13) SEG(14) SEG(15)
+
+int _start() {
+    return seg0[0] + seg1[0] + seg2[0] + seg3[0] + seg4[0] + seg5[0] + seg6[0] + seg7[0] +
+           seg8[0] + seg9[0] + seg10[0] + seg11[0] + seg12[0] + seg13[0] + seg14[0] + seg15[0];
+}
@@ -0,0 +1,15 @@
+// Random page-granular reads over a large initialised array
+#define PAGES 1024
+#define TOUCHES 20000
+
+static int table[PAGES * 1024] = { 1 };
+
+int _start() {
+    unsigned int seed = 12345;
+    int sum = 0;
+    for (int i = 0; i < TOUCHES; i++) {
+        seed = seed * 1103515245 + 12345;
+        sum += table[(seed >> 8) % (PAGES * 1024)];
+    }
+    return sum;
+}
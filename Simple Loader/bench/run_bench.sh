@@ -0,0 +1,26 @@
+#!/bin/bash
+# Runs every workload under every loader mode and prints one CSV row per run.
+# Usage: ./run_bench.sh [workload...]   (REPEAT=n to change the run count)
+
+REPEAT=${REPEAT:-5}
+MODES="lazy faultaround filemap eager"
+WORKLOADS=${@:-bigbss bigtext manyseg randacc seqscan unaligned}
+
+stat_of() {
+    echo "$1" | awk -F': ' -v key="$2" '$1 == key { split($2, v, " "); print v[1] }'
+}
+
+echo "workload,mode,run,wall_ms,page_faults,allocations,bytes_read,bytes_mapped,fragmentation_kb,output"
+for workload in $WORKLOADS; do
+    for mode in $MODES; do
+        for run in $(seq 1 "$REPEAT"); do
+            start=$(date +%s%N)
+            out=$(./loader -q -M "$mode" "./$workload")
+            finish=$(date +%s%N)
+            wall=$(awk -v s="$start" -v f="$finish" 'BEGIN { printf "%.3f", (f - s) / 1e6 }')
+            echo "$workload,$mode,$run,$wall,$(stat_of "$out" "Page faults"),$(stat_of "$out" "Page allocations")," \
+                 "$(stat_of "$out" "Bytes read"),$(stat_of "$out" "Bytes mapped from file")," \
+                 "$(stat_of "$out" "Internal Fragmentation"),$(stat_of "$out" "Program's Output")" | tr -d ' '
+        done
+    done
+done
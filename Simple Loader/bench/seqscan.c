@@ -0,0 +1,12 @@
+// Front to back scan of a large initialised array
+#define PAGES 1024
+
+static int table[PAGES * 1024] = { 1 };
+
+int _start() {
+    int sum = 0;
+    for (int i = 0; i < PAGES * 1024; i += 16) {
+        sum += table[i] + 1;
+    }
+    return sum;
+}
@@ -0,0 +1,16 @@
+// Writes an initialised array in a data segment that does not start on a
+// page boundary (see unaligned.ld), so that the reset between repeated runs
+// (-n) has to restore a page lying partly below the segment's p_vaddr. The
+// result only repeats if every run starts from the pristine contents.
+#define PAGES 8
+
+static int table[PAGES * 1024] = { 1, 2, 3 };
+
+int _start() {
+    int sum = 0;
+    for (int i = 0; i < PAGES * 1024; i += 256) {
+        table[i] += i + 1;
+        sum += table[i];
+    }
+    return sum % 251;
+}
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE     // sched_setaffinity and the CPU_* macros
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,12 +17,19 @@
 #include <wait.h>
 #include <sys/time.h>
 #include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/syscall.h>
 
 #define SHM_NAME "/my_shm"
 
 Shared_queue *shared_queue;
-int* number_of_jobs;
-int shm_fd_1, shm_fd_2;
+size_t shared_queue_bytes;
+int shm_fd_1;
+int job_slots;                   // Slots mapped here and covered by the per-slot state
+unsigned int table_generation;   // The shell's generation job_slots was read at
 
 // Function to reconnect resources in the exec'ed child process
 void reconnect_resources_after_exec() {
@@ -31,32 +39,25 @@ void reconnect_resources_after_exec() {
         exit(1);
     }
 
-    shared_queue = (Shared_queue*) mmap(NULL, 2046, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd_1, 0);
-    if (shared_queue == MAP_FAILED) {
+    // The shell picks the capacity and may grow the table at any time; map
+    // the header first, then the slots there were at this generation
+    shared_queue = job_table_reserve();
+    if (shared_queue == NULL || job_table_map(shared_queue, shm_fd_1, 0) == -1) {
         perror("Shared memory re-mapping failed in child");
         exit(1);
     }
-
-    // Re-attach shm_fd_2 for number_of_jobs
-    int shm_fd_2 = shmget(IPC_PRIVATE, sizeof(int), 0666);
-    if (shm_fd_2 < 0) {
-        perror("Failed to re-access shared memory segment in child");
-        exit(EXIT_FAILURE);
-    }
-
-    number_of_jobs = (int *)shmat(shm_fd_2, NULL, 0);
-    if (number_of_jobs == (void *)-1) {
-        perror("Failed to re-attach shared memory segment in child");
-        shmctl(shm_fd_2, IPC_RMID, NULL); // Cleanup if attachment failed
-        exit(EXIT_FAILURE);
+    table_generation = atomic_load_explicit(&shared_queue->generation, memory_order_acquire);
+    job_slots = shared_queue->capacity;
+    if (job_table_map(shared_queue, shm_fd_1, job_slots) == -1) {
+        perror("Shared memory re-mapping failed in child");
+        exit(1);
     }
 }
 
 void cleanup_shared_resources() {
-    munmap(shared_queue, 2046);
+    munmap(shared_queue, shared_queue_size(ARENA_MAX_JOBS));
     close(shm_fd_1);
     shm_unlink(SHM_NAME);
-    shmctl(shm_fd_2, IPC_RMID, NULL);
 }
 
 
@@ -65,121 +66,1479 @@ long get_current_time_ms() {
     gettimeofday(&time, NULL);
     return time.tv_sec * 1000 + time.tv_usec / 1000;
 }
-// Function to check if a job is completed
-int is_completed(pid_t pid) {
-    int status;
-    pid_t result = waitpid(pid, &status, WNOHANG);
-    return result == pid && WIFEXITED(status);
+// Event loop sources; pidfds are registered with their slot as the tag
+#define WAKEUP_SOURCE -1
+#define TIMER_SOURCE -2
+
+int epoll_fd;
+int timer_fd;
+int *job_pidfds;                 // pidfd watching each slot's job, -1 when none
+job_list on_cpu;                 // RUNNING jobs, linked through their slots
+int n_cpus;
+int *cpu_job;                    // Slot running on each CPU, NO_JOB when idle
+int *cores;                      // Core each CPU is pinned to
+int n_cores;
+int *pinned_cpu;                 // CPU each slot's affinity was last set for
+char *on_core;                   // Slot has not been SIGSTOPped since it last ran
+clockid_t *job_clock;            // CPU-time clock of each slot's job
+char *has_clock;
+long long *cpu_seen_ns;          // Job's CPU clock when it was last charged
+int pending_gang = NO_JOB;       // Gang picked but still waiting for enough idle CPUs
+int *run_heap;                   // Run heap of cfs, srtf and edf, sized like the slots
+int heap_count;                  // READY jobs in the run heap
+int *vacated;                    // Jobs taken off a CPU during this slice boundary
+char *is_vacated;
+int n_vacated;
+sched_stats stats;               // Published to the shared table by publish_stats()
+bool slice_active = false;
+struct timespec slice_deadline;  // Absolute end of the current slice
+sched_options options;
+
+// A scheduling policy owns the READY jobs. A job is on exactly one list at a
+// time: one of the policy's while it waits, on_cpu while it runs. pick_next
+// is asked for a job for one particular CPU.
+typedef struct sched_policy {
+    const char *name;
+    void (*admit)(int slot);                  // A submitted job became READY
+    void (*requeue)(int slot, bool expired);  // A job came off its CPU
+    void (*retire)(int slot);                 // A READY job left the system
+    int (*pick_next)(int cpu);                // Take the next job for a CPU off the lists
+    bool (*charge)(int slot, long used_us);   // Account CPU used; true once the quantum is used up
+    int (*victim)(void);                      // Running job that should yield to a waiting one
+    void (*periodic)(long now);               // Housekeeping once per slice
+    bool (*before)(int a, int b);             // Order of the run heap, NULL when unused
+} sched_policy;
+
+sched_policy *policy;
+bool dry_run = false;            // Benchmark or simulation: jobs are fake, never signal them
+bool simulating = false;         // Time comes from the simulator's virtual clock
+long long sim_now_us;
+long long *sim_remaining_us;     // CPU each simulated job still needs
+long long *sim_first_run_us;     // When it first ran, -1 before
+void sim_job_started(int slot);
+void sim_job_stopped(int slot);
+
+long scheduler_time_ms() {
+    return simulating ? sim_now_us / 1000 : get_current_time_ms();
+}
+
+long long monotonic_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+long long scheduler_time_us() {
+    return simulating ? sim_now_us : monotonic_ns() / 1000;
+}
+
+// Adaptive quantum (-A min:max). Every few slices the quantum moves halfway
+// towards a target: short enough that each waiting job gets a CPU within
+// about max ms, long enough to cover the runs of jobs that mostly exit
+// before their slice ends, and never so short that slice boundaries cost
+// more than ADAPT_OVERHEAD_PCT of it.
+#define ADAPT_WINDOW 4           // Slices between adjustments
+#define ADAPT_OVERHEAD_PCT 1
+
+int quantum_ms;                  // Slice length in effect, TSLICE when not adaptive
+long long *cpu_since_us;         // When each CPU's job started or was last charged
+int adapt_slices;
+long adapt_waiting;              // Waiting jobs summed over the window's slices
+long adapt_expired;              // Runs that reached a slice boundary
+long adapt_early;                // Runs that ended with the job exiting
+double early_run_us;             // Average length of those runs
+double boundary_cost_ns;         // Average time a slice boundary takes, signals included
+
+// -l: every signal is timed until /proc shows that it took effect. A job
+// has switched out once its state is stopped, and switched in once its run
+// count in schedstat goes up, i.e. it was really put on a core, or, without
+// schedstat, once it is no longer stopped. Pending probes are polled at
+// the end of each wakeup for a short budget that never runs past the armed
+// slice deadline; the rest carry over, and the event loop wakes up again
+// after PROBE_RETRY_MS while any are left.
+#define PROBE_POLL_NS 20000      // Pause between two rounds of /proc reads
+#define PROBE_BUDGET_NS 200000   // Longest a wakeup polls for
+#define PROBE_RETRY_MS 1         // Event loop timeout while probes are pending
+
+typedef struct signal_probe {
+    pid_t pid;
+    int sig;
+    long runs;                   // Run count before a SIGCONT, -1 without schedstat
+    long long sent_ns;
+} signal_probe;
+
+signal_probe *probes;            // Unconfirmed signals, extra ones go untimed
+int n_probes, probe_capacity;
+
+// Copy a small /proc file of the job into buffer; false once it is gone
+bool read_proc_file(pid_t pid, const char *file, char *buffer, size_t size) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/%s", pid, file);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) return false;
+    ssize_t got = read(fd, buffer, size - 1);
+    close(fd);
+    if (got <= 0) return false;
+    buffer[got] = '\0';
+    return true;
+}
+
+// State letter of /proc/<pid>/stat, after the parenthesised name, or 0
+char proc_state(pid_t pid) {
+    char buffer[512];
+    if (!read_proc_file(pid, "stat", buffer, sizeof(buffer))) return 0;
+    char *end = strrchr(buffer, ')');
+    return end != NULL && end[1] == ' ' ? end[2] : 0;
+}
+
+// Times the job was put on a core, the third field of schedstat, or -1
+long proc_run_count(pid_t pid) {
+    char buffer[128];
+    long long run_ns, wait_ns;
+    long runs;
+    if (!read_proc_file(pid, "schedstat", buffer, sizeof(buffer)) ||
+        sscanf(buffer, "%lld %lld %ld", &run_ns, &wait_ns, &runs) != 3) {
+        return -1;
+    }
+    return runs;
 }
 
-command* get_next_job() {
-    command* temp = shared_queue->head;
+// 1 once the signal took effect, 0 while it has not, -1 if the job is gone
+int probe_done(signal_probe *probe) {
+    char state = proc_state(probe->pid);
+    if (state == 0 || state == 'Z' || state == 'X') return -1;
+    bool stopped = state == 'T' || state == 't';
+    if (probe->sig == SIGSTOP) return stopped;
+    if (probe->runs >= 0) return proc_run_count(probe->pid) > probe->runs;
+    return !stopped;
+}
+
+// Record a probe that took effect and drop it; false while still pending
+bool settle_probe(int i, bool give_up) {
+    int done = probe_done(&probes[i]);
+    if (done == 1) {
+        latency_record(probes[i].sig == SIGSTOP ? stats.switch_out : stats.switch_in,
+                       monotonic_ns() - probes[i].sent_ns);
+    } else if (done == 0) {
+        if (!give_up) return false;
+        stats.probe_timeouts++;
+    }
+    probes[i] = probes[--n_probes];
+    return true;
+}
+
+void start_probe(command *job, int sig) {
+    // The job's next signal would make its pending probe unreadable
+    for (int i = 0; i < n_probes; i++) {
+        if (probes[i].pid == job->pid) {
+            settle_probe(i, true);
+            break;
+        }
+    }
+    if (n_probes == probe_capacity) return;
+    signal_probe *probe = &probes[n_probes++];
+    probe->pid = job->pid;
+    probe->sig = sig;
+    probe->runs = sig == SIGCONT ? proc_run_count(job->pid) : -1;
+    probe->sent_ns = monotonic_ns();
+}
+
+// Poll the pending probes for at most PROBE_BUDGET_NS, and never past the
+// armed slice deadline, so the next boundary is not delayed. Probes still
+// pending carry over to the next wakeup; those a slice old are given up.
+void confirm_signals() {
+    long long now_ns = monotonic_ns();
+    long long stop_ns = now_ns + PROBE_BUDGET_NS;
+    if (slice_active) {
+        long long deadline_ns = (long long)slice_deadline.tv_sec * 1000000000LL + slice_deadline.tv_nsec;
+        if (deadline_ns < stop_ns) stop_ns = deadline_ns;
+    }
+    while (n_probes > 0) {
+        for (int i = 0; i < n_probes; i++) {
+            bool stale = now_ns - probes[i].sent_ns > quantum_ms * 1000000LL;
+            if (settle_probe(i, stale)) i--;
+        }
+        now_ns = monotonic_ns();
+        if (n_probes == 0 || now_ns + PROBE_POLL_NS > stop_ns) break;
+        struct timespec pause = { 0, PROBE_POLL_NS };
+        nanosleep(&pause, NULL);
+        now_ns = monotonic_ns();
+    }
+}
+
+// Every job leads its own process group, so one killpg stops or resumes
+// the job together with any helpers it forked
+void signal_job(command *job, int sig) {
+    if (sig == SIGSTOP) {
+        stats.sigstops++;
+    } else {
+        stats.sigconts++;
+    }
+    if (dry_run) return;
+    if (options.probe_signals) start_probe(job, sig);
+    killpg(job->pid, sig);
+}
+
+int no_victim(void) {
+    return NO_JOB;
+}
+
+// Round robin: one queue per CPU and every job gives up its CPU after one
+// slice, unless nothing else waits on that CPU. An idle CPU steals from the
+// longest queue and queues are rebalanced at every slice boundary.
+job_list *rr_queues;
+
+int rr_load(int cpu) {
+    return rr_queues[cpu].count + (cpu_job[cpu] != NO_JOB);
+}
+
+void rr_admit(int slot) {
+    int target = 0;
+    for (int cpu = 1; cpu < n_cpus; cpu++) {
+        if (rr_load(cpu) < rr_load(target)) target = cpu;
+    }
+    job_at(shared_queue, slot)->cpu = target;
+    list_push_back(shared_queue, &rr_queues[target], slot);
+}
+
+void rr_requeue(int slot, bool expired) {
+    list_push_back(shared_queue, &rr_queues[job_at(shared_queue, slot)->cpu], slot);
+}
+
+void rr_retire(int slot) {
+    list_remove(shared_queue, &rr_queues[job_at(shared_queue, slot)->cpu], slot);
+}
+
+// Move the most recently queued job of one CPU to the end of another's
+void rr_migrate(int from, int to) {
+    int slot = rr_queues[from].tail;
+    list_remove(shared_queue, &rr_queues[from], slot);
+    job_at(shared_queue, slot)->cpu = to;
+    list_push_back(shared_queue, &rr_queues[to], slot);
+}
+
+command* get_next_job(int cpu) {
+    command* temp = job_at(shared_queue, rr_queues[cpu].head);
     while(temp != NULL){
         if(temp->pid > 0 && temp->status == READY){
             return temp;
         }
-        temp = temp->next;
+        temp = job_at(shared_queue, temp->next);
     }
     return NULL;
 }
 
-void move_n_nodes_to_end(command* head, int n) {
-    if (head == NULL || n <= 0) return;  // If the list is empty or n <= 0, do nothing
+int rr_pick_next(int cpu) {
+    if (rr_queues[cpu].count == 0) {
+        int busiest = NO_JOB;
+        for (int other = 0; other < n_cpus; other++) {
+            if (rr_queues[other].count > 0 && (busiest == NO_JOB || rr_queues[other].count > rr_queues[busiest].count)) {
+                busiest = other;
+            }
+        }
+        if (busiest == NO_JOB) return NO_JOB;
+        rr_migrate(busiest, cpu);
+    }
+    command *job = get_next_job(cpu);
+    if (job == NULL) return NO_JOB;
+    int slot = job - shared_queue->jobs;
+    rr_retire(slot);
+    return slot;
+}
+
+bool rr_charge(int slot, long used_us) {
+    return true;
+}
+
+void rr_periodic(long now) {
+    for (;;) {
+        int longest = 0, shortest = 0;
+        for (int cpu = 1; cpu < n_cpus; cpu++) {
+            if (rr_load(cpu) > rr_load(longest)) longest = cpu;
+            if (rr_load(cpu) < rr_load(shortest)) shortest = cpu;
+        }
+        if (rr_load(longest) - rr_load(shortest) <= 1 || rr_queues[longest].count == 0) break;
+        rr_migrate(longest, shortest);
+    }
+}
+
+sched_policy round_robin = {
+    "rr", rr_admit, rr_requeue, rr_retire, rr_pick_next, rr_charge, no_victim, rr_periodic, NULL
+};
+
+// Multi-level feedback queue: level k runs jobs for quantum << k before
+// demoting them, higher levels preempt lower ones at slice boundaries and
+// every boost period all jobs go back to the top to avoid starvation
+job_list mlfq_queues[MLFQ_MAX_LEVELS];
+long last_boost;
+
+int mlfq_quantum(int level) {
+    return quantum_ms << level;
+}
+
+void mlfq_admit(int slot) {
+    command *job = job_at(shared_queue, slot);
+    job->level = job->priority - 1;
+    if (job->level >= options.levels) job->level = options.levels - 1;
+    job->quantum_used = 0;
+    list_push_back(shared_queue, &mlfq_queues[job->level], slot);
+}
+
+void mlfq_requeue(int slot, bool expired) {
+    command *job = job_at(shared_queue, slot);
+    if (expired) {
+        if (job->level < options.levels - 1) job->level++;
+        job->quantum_used = 0;
+    }
+    list_push_back(shared_queue, &mlfq_queues[job->level], slot);
+}
+
+void mlfq_retire(int slot) {
+    list_remove(shared_queue, &mlfq_queues[job_at(shared_queue, slot)->level], slot);
+}
+
+int mlfq_pick_next(int cpu) {
+    for (int level = 0; level < options.levels; level++) {
+        int slot = list_pop_front(shared_queue, &mlfq_queues[level]);
+        if (slot != NO_JOB) return slot;
+    }
+    return NO_JOB;
+}
+
+bool mlfq_charge(int slot, long used_us) {
+    command *job = job_at(shared_queue, slot);
+    job->quantum_used += used_us;
+    // Slices are charged the CPU time really used, which comes out a hair
+    // under a slice for a job that ran throughout; allow a tenth of a slice
+    return job->quantum_used >= mlfq_quantum(job->level) * 1000L - quantum_ms * 100L;
+}
+
+// The lowest running job, if a waiting job sits on a higher level
+int mlfq_victim(void) {
+    int waiting = 0;
+    while (waiting < options.levels && mlfq_queues[waiting].count == 0) waiting++;
+
+    int victim = NO_JOB;
+    for (int slot = on_cpu.head; slot != NO_JOB; slot = job_at(shared_queue, slot)->next) {
+        int level = job_at(shared_queue, slot)->level;
+        if (level > waiting && (victim == NO_JOB || level > job_at(shared_queue, victim)->level)) {
+            victim = slot;
+        }
+    }
+    return victim;
+}
+
+void mlfq_periodic(long now) {
+    int boost_ms = options.boost_ms > 0 ? options.boost_ms : 50 * TSLICE;
+    if (now - last_boost < boost_ms) return;
+    last_boost = now;
+
+    for (int level = 1; level < options.levels; level++) {
+        int slot;
+        while ((slot = list_pop_front(shared_queue, &mlfq_queues[level])) != NO_JOB) {
+            list_push_back(shared_queue, &mlfq_queues[0], slot);
+        }
+    }
+    for (int slot = 0; slot < job_slots; slot++) {
+        command *job = job_at(shared_queue, slot);
+        if (job->status == READY || job->status == RUNNING) {
+            job->level = 0;
+            job->quantum_used = 0;
+        }
+    }
+}
+
+sched_policy mlfq = {
+    "mlfq", mlfq_admit, mlfq_requeue, mlfq_retire, mlfq_pick_next, mlfq_charge, mlfq_victim, mlfq_periodic, NULL
+};
+
+// Run heap: READY jobs of cfs, srtf and edf sit in a binary min-heap of
+// slots in the order of policy->before, so the NCPU jobs that should run
+// next are found in O(NCPU log n).
+void heap_place(int *heap, int index, int slot) {
+    heap[index] = slot;
+    job_at(shared_queue, slot)->heap_index = index;
+}
+
+void heap_sift_up(int *heap, int index) {
+    int slot = heap[index];
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!policy->before(slot, heap[parent])) break;
+        heap_place(heap, index, heap[parent]);
+        index = parent;
+    }
+    heap_place(heap, index, slot);
+}
+
+void heap_sift_down(int *heap, int index) {
+    int slot = heap[index];
+    int count = heap_count;
+    for (;;) {
+        int child = 2 * index + 1;
+        if (child >= count) break;
+        if (child + 1 < count && policy->before(heap[child + 1], heap[child])) child++;
+        if (!policy->before(heap[child], slot)) break;
+        heap_place(heap, index, heap[child]);
+        index = child;
+    }
+    heap_place(heap, index, slot);
+}
+
+void heap_push(int slot, bool expired) {
+    heap_place(run_heap, heap_count++, slot);
+    heap_sift_up(run_heap, heap_count - 1);
+}
+
+void heap_retire(int slot) {
+    int index = job_at(shared_queue, slot)->heap_index;
+    int last = run_heap[--heap_count];
+    job_at(shared_queue, slot)->heap_index = -1;
+    if (last == slot) return;
+    heap_place(run_heap, index, last);
+    heap_sift_up(run_heap, index);
+    heap_sift_down(run_heap, job_at(shared_queue, last)->heap_index);
+}
+
+void heap_admit(int slot) {
+    heap_push(slot, false);
+}
+
+int heap_pick_next(int cpu) {
+    if (heap_count == 0) return NO_JOB;
+    int slot = run_heap[0];
+    heap_retire(slot);
+    return slot;
+}
+
+// The running job that comes last in the heap's order, if the heap holds
+// one that comes before it
+int heap_victim(void) {
+    if (heap_count == 0) return NO_JOB;
+    int waiting = run_heap[0];
+    int victim = NO_JOB;
+    for (int slot = on_cpu.head; slot != NO_JOB; slot = job_at(shared_queue, slot)->next) {
+        if (policy->before(waiting, slot) && (victim == NO_JOB || policy->before(victim, slot))) {
+            victim = slot;
+        }
+    }
+    return victim;
+}
+
+void no_periodic(long now) {
+}
+
+// Ties go to the job submitted first, then to the lower slot
+bool submitted_before(int a, int b) {
+    command *x = job_at(shared_queue, a);
+    command *y = job_at(shared_queue, b);
+    return x->start_time < y->start_time || (x->start_time == y->start_time && a < b);
+}
+
+// Completely fair: running advances a job's vruntime by the time it ran
+// divided by its weight, priority p gets half the weight of p - 1, and the
+// heap keeps the least advanced jobs first.
+long min_vruntime;
+
+int cfs_weight(command *job) {
+    return 1024 >> (job->priority - 1);
+}
+
+bool vruntime_before(int a, int b) {
+    command *x = job_at(shared_queue, a);
+    command *y = job_at(shared_queue, b);
+    return x->vruntime < y->vruntime || (x->vruntime == y->vruntime && a < b);
+}
+
+// A new job starts level with the least advanced job so it cannot hog the
+// CPUs to catch up
+void cfs_admit(int slot) {
+    command *job = job_at(shared_queue, slot);
+    if (job->vruntime < min_vruntime) job->vruntime = min_vruntime;
+    heap_push(slot, false);
+}
+
+bool cfs_charge(int slot, long used_us) {
+    command *job = job_at(shared_queue, slot);
+    job->vruntime += used_us * 1024 / cfs_weight(job);
+    return false;  // Preemption is decided by heap_victim against the heap
+}
+
+void cfs_periodic(long now) {
+    long least = heap_count > 0 ? job_at(shared_queue, run_heap[0])->vruntime : -1;
+    for (int slot = on_cpu.head; slot != NO_JOB; slot = job_at(shared_queue, slot)->next) {
+        long vruntime = job_at(shared_queue, slot)->vruntime;
+        if (least == -1 || vruntime < least) least = vruntime;
+    }
+    if (least > min_vruntime) min_vruntime = least;
+}
+
+sched_policy cfs = {
+    "cfs", cfs_admit, heap_push, heap_retire, heap_pick_next, cfs_charge, heap_victim, cfs_periodic, vruntime_before
+};
+
+// Shortest remaining time first: the job with the least of its est= estimate
+// left runs, and a shorter one waiting preempts it at the next slice
+// boundary. Jobs without an estimate come after all others, first come
+// first served, as do jobs that ran past their estimate.
+bool remaining_before(int a, int b) {
+    long x = job_at(shared_queue, a)->remaining_time;
+    long y = job_at(shared_queue, b)->remaining_time;
+    if (x < 0) x = LONG_MAX;
+    if (y < 0) y = LONG_MAX;
+    return x < y || (x == y && submitted_before(a, b));
+}
+
+bool srtf_charge(int slot, long used_us) {
+    command *job = job_at(shared_queue, slot);
+    if (job->remaining_time > 0) {
+        job->remaining_time = job->remaining_time > used_us ? job->remaining_time - used_us : 0;
+    }
+    return false;
+}
+
+sched_policy srtf = {
+    "srtf", heap_admit, heap_push, heap_retire, heap_pick_next, srtf_charge, heap_victim, no_periodic, remaining_before
+};
+
+// Earliest deadline first: the job whose deadline= comes first runs, and one
+// with an earlier deadline preempts it at the next slice boundary. Jobs
+// without a deadline come after all others, first come first served.
+bool deadline_before(int a, int b) {
+    long x = job_at(shared_queue, a)->deadline;
+    long y = job_at(shared_queue, b)->deadline;
+    if (x == 0) x = LONG_MAX;
+    if (y == 0) y = LONG_MAX;
+    return x < y || (x == y && submitted_before(a, b));
+}
+
+bool edf_charge(int slot, long used_us) {
+    return false;
+}
+
+sched_policy edf = {
+    "edf", heap_admit, heap_push, heap_retire, heap_pick_next, edf_charge, heap_victim, no_periodic, deadline_before
+};
+
+sched_policy *policies[] = { &round_robin, &mlfq, &cfs, &srtf, &edf, NULL };
+
+void *alloc_or_die(size_t bytes) {
+    void *memory = calloc(1, bytes);
+    if (memory == NULL) {
+        perror("Scheduler state allocation failed");
+        exit(1);
+    }
+    return memory;
+}
+
+void *realloc_or_die(void *memory, size_t bytes) {
+    memory = realloc(memory, bytes);
+    if (memory == NULL) {
+        perror("Scheduler state allocation failed");
+        exit(1);
+    }
+    return memory;
+}
+
+// Size the per-slot state for slots [from, to) on top of what is there
+void grow_slot_state(int from, int to) {
+    pinned_cpu = realloc_or_die(pinned_cpu, sizeof(int) * to);
+    run_heap = realloc_or_die(run_heap, sizeof(int) * to);
+    on_core = realloc_or_die(on_core, to);
+    job_clock = realloc_or_die(job_clock, sizeof(clockid_t) * to);
+    has_clock = realloc_or_die(has_clock, to);
+    cpu_seen_ns = realloc_or_die(cpu_seen_ns, sizeof(long long) * to);
+    vacated = realloc_or_die(vacated, sizeof(int) * to);
+    is_vacated = realloc_or_die(is_vacated, to);
+    for (int slot = from; slot < to; slot++) {
+        pinned_cpu[slot] = -1;
+        on_core[slot] = 0;
+        has_clock[slot] = 0;
+        cpu_seen_ns[slot] = 0;
+        is_vacated[slot] = 0;
+    }
+}
+
+// Per-CPU and per-slot state; CPUs are spread over the cores this process
+// may run on, so NCPU larger than the machine wraps around
+void setup_cpus(int n_cpu, int capacity) {
+    n_cpus = n_cpu;
+    cpu_job = alloc_or_die(sizeof(int) * n_cpu);
+    cpu_since_us = alloc_or_die(sizeof(long long) * n_cpu);
+    rr_queues = alloc_or_die(sizeof(job_list) * n_cpu);
+    for (int cpu = 0; cpu < n_cpu; cpu++) {
+        cpu_job[cpu] = NO_JOB;
+        list_init(&rr_queues[cpu]);
+    }
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    cores = alloc_or_die(sizeof(int) * CPU_SETSIZE);
+    n_cores = 0;
+    for (int core = 0; core < CPU_SETSIZE; core++) {
+        if (CPU_ISSET(core, &allowed)) cores[n_cores++] = core;
+    }
+    if (n_cores == 0) cores[n_cores++] = 0;
+
+    grow_slot_state(0, capacity);
+    n_vacated = 0;
+}
+
+void free_cpus() {
+    free(cpu_job);
+    free(cpu_since_us);
+    free(rr_queues);
+    free(cores);
+    free(pinned_cpu);
+    free(on_core);
+    free(job_clock);
+    free(has_clock);
+    free(cpu_seen_ns);
+    free(vacated);
+    free(is_vacated);
+    pinned_cpu = NULL;
+    on_core = NULL;
+    job_clock = NULL;
+    has_clock = NULL;
+    cpu_seen_ns = NULL;
+    vacated = NULL;
+    is_vacated = NULL;
+}
+
+void reset_policy_state(long now) {
+    list_init(&on_cpu);
+    for (int level = 0; level < MLFQ_MAX_LEVELS; level++) {
+        list_init(&mlfq_queues[level]);
+    }
+    last_boost = now;
+    min_vruntime = 0;
+    heap_count = 0;
+    pending_gang = NO_JOB;
+}
+
+void record_quantum(long now) {
+    stats.quantum_ms = quantum_ms;
+    quantum_change *change = &stats.quantum_history[stats.quantum_changes % QUANTUM_HISTORY];
+    change->time_ms = now - stats.started_ms;
+    change->quantum_ms = quantum_ms;
+    stats.quantum_changes++;
+}
+
+// Also starts the statistics over, the quantum history is part of them
+void init_quantum(long now) {
+    memset(&stats, 0, sizeof(stats));
+    stats.started_ms = now;
+    quantum_ms = TSLICE;
+    stats.adaptive = options.adapt_max_ms > 0;
+    if (stats.adaptive) {
+        if (quantum_ms < options.adapt_min_ms) quantum_ms = options.adapt_min_ms;
+        if (quantum_ms > options.adapt_max_ms) quantum_ms = options.adapt_max_ms;
+    }
+    adapt_slices = 0;
+    adapt_waiting = adapt_expired = adapt_early = 0;
+    early_run_us = 0;
+    boundary_cost_ns = 0;
+    record_quantum(now);
+}
+
+void adapt_quantum(int n_cpu, long now) {
+    if (options.adapt_max_ms == 0) return;
+    adapt_waiting += atomic_load(&shared_queue->number_of_jobs) - on_cpu.count;
+    if (++adapt_slices < ADAPT_WINDOW) return;
+
+    // Queue depth: one round over the waiting jobs takes about max ms
+    long waiting = adapt_waiting / adapt_slices;
+    long target = (long)options.adapt_max_ms * n_cpu / (waiting + n_cpu);
+    // Early exits: a job that would have finished just after the boundary
+    // is not stopped and resumed for the last bit of its run
+    if (adapt_early > adapt_expired) {
+        long cover = (long)(early_run_us * 5 / 4 / 1000) + 1;
+        if (cover > target) target = cover;
+    }
+    // Overhead: what the boundaries cost in scheduler time and signals
+    long floor = (long)(boundary_cost_ns * 100 / ADAPT_OVERHEAD_PCT / 1000000) + 1;
+    if (floor > target) target = floor;
+    if (target < options.adapt_min_ms) target = options.adapt_min_ms;
+    if (target > options.adapt_max_ms) target = options.adapt_max_ms;
+
+    adapt_slices = 0;
+    adapt_waiting = adapt_expired = adapt_early = 0;
+    if (target == quantum_ms) return;
+    quantum_ms = target > quantum_ms ? (quantum_ms + target + 1) / 2 : (quantum_ms + target) / 2;
+    record_quantum(now);
+}
+
+// A running job exited: remember how far into its slice it got
+void note_early_exit(int cpu) {
+    double run_us = scheduler_time_us() - cpu_since_us[cpu];
+    early_run_us = early_run_us == 0 ? run_us : early_run_us * 7 / 8 + run_us / 8;
+    adapt_early++;
+}
+
+void watch_source(int fd, int source) {
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = (uint64_t)(uint32_t)source << 32 | (uint32_t)fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1) {
+        perror("epoll_ctl failed");
+        exit(1);
+    }
+}
+
+void setup_event_loop() {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (epoll_fd == -1 || timer_fd == -1) {
+        perror("Scheduler event loop setup failed");
+        exit(1);
+    }
+    watch_source(shared_queue->wakeup_fd, WAKEUP_SOURCE);
+    watch_source(timer_fd, TIMER_SOURCE);
+
+    job_pidfds = malloc(sizeof(int) * job_slots);
+    if (job_pidfds == NULL) {
+        perror("Failed to allocate pidfd table");
+        exit(1);
+    }
+    for (int slot = 0; slot < job_slots; slot++) {
+        job_pidfds[slot] = -1;
+    }
+    setup_cpus(NCPU, job_slots);
+    if (options.probe_signals) {
+        probe_capacity = 4 * NCPU;
+        probes = alloc_or_die(sizeof(signal_probe) * probe_capacity);
+    }
+    reset_policy_state(get_current_time_ms());
+    init_quantum(get_current_time_ms());
+}
+
+// The jobs are the shell's children, so exits are observed through pidfds
+void watch_job(int slot) {
+    if (dry_run) return;
+    has_clock[slot] = clock_getcpuclockid(job_at(shared_queue, slot)->pid, &job_clock[slot]) == 0;
+    cpu_seen_ns[slot] = 0;
+    int fd = syscall(SYS_pidfd_open, job_at(shared_queue, slot)->pid, 0);
+    if (fd == -1) {
+        return;  // Already gone, the shell's completion event follows
+    }
+    job_pidfds[slot] = fd;
+    watch_source(fd, slot);
+}
 
-    command* current = head;
-    command* new_head = NULL;
-    command* new_tail = NULL;
+void unwatch_job(int slot) {
+    if (dry_run || job_pidfds[slot] == -1) return;
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, job_pidfds[slot], NULL);
+    close(job_pidfds[slot]);
+    job_pidfds[slot] = -1;
+}
 
-    // Traverse to the nth node
-    for (int i = 1; i < n && current->next != NULL; i++) {
-        current = current->next;
+// Free the CPU a job ran on, or every CPU a gang held
+void release_cpus(int slot) {
+    command *job = job_at(shared_queue, slot);
+    if (job->width <= 1) {
+        cpu_job[job->cpu] = NO_JOB;
+        return;
     }
+    for (int cpu = 0; cpu < n_cpus; cpu++) {
+        if (cpu_job[cpu] == slot) cpu_job[cpu] = NO_JOB;
+    }
+}
+
+// Take a job that is leaving the system off whichever list holds it
+void drop_job(int slot) {
+    command *job = job_at(shared_queue, slot);
+    if (slot == pending_gang) {
+        pending_gang = NO_JOB;
+    } else if (job->status == READY) {
+        policy->retire(slot);
+    } else if (job->status == RUNNING) {
+        list_remove(shared_queue, &on_cpu, slot);
+        release_cpus(slot);
+        note_early_exit(job->cpu);
+    }
+    on_core[slot] = 0;
+    job->status = COMPLETED;
+    unwatch_job(slot);
+}
+
+void admit_job(int slot) {
+    command *job = job_at(shared_queue, slot);
+    if (job->width > n_cpus) job->width = n_cpus;
+    policy->admit(slot);
+    atomic_fetch_add(&shared_queue->number_of_jobs, 1);
+    watch_job(slot);
+}
+
+// The shell grew the table: map the new slots at the same address and size
+// the per-slot state for them before any of their events is handled
+void follow_job_table_growth() {
+    unsigned int generation = atomic_load_explicit(&shared_queue->generation, memory_order_acquire);
+    if (generation == table_generation) return;
+    table_generation = generation;
+    int capacity = shared_queue->capacity;
+    if (job_table_map(shared_queue, shm_fd_1, capacity) == -1) {
+        perror("Job table remapping failed");
+        exit(1);
+    }
+    grow_slot_state(job_slots, capacity);
+    job_pidfds = realloc_or_die(job_pidfds, sizeof(int) * capacity);
+    for (int slot = job_slots; slot < capacity; slot++) {
+        job_pidfds[slot] = -1;
+    }
+    job_slots = capacity;
+}
 
-    // If `n` is greater than the length of the list, do nothing
-    if (current == NULL || current->next == NULL) return;
+// Admit new jobs and retire finished ones; only the scheduler touches the run queue
+void drain_job_events() {
+    uint64_t pending;
+    ssize_t got = read(shared_queue->wakeup_fd, &pending, sizeof(pending));
+    (void)got;
 
-    // `new_head` is the head of the new list after moving nodes
-    new_head = current->next;
-    // `new_tail` is the end of the first `n` nodes
-    new_tail = head;
+    int type, slot;
+    while (event_ring_pop(&shared_queue->events, &type, &slot)) {
+        follow_job_table_growth();
+        if (type == JOB_SUBMITTED) {
+            admit_job(slot);
+        } else if (type == JOB_BATCH_SUBMITTED) {
+            while (slot != NO_JOB) {
+                int next = job_at(shared_queue, slot)->next;
+                admit_job(slot);
+                slot = next;
+            }
+        } else {
+            drop_job(slot);
+            atomic_fetch_sub(&shared_queue->number_of_jobs, 1);
+            stats.completed++;
+            job_free(shared_queue, slot);
+        }
+    }
+}
+
+// CPU time a job really used since it was last charged, read from its CPU
+// clock, so partial slices and jobs that block are charged what they used
+long job_cpu_used_us(int slot, int time_slice) {
+    struct timespec now;
+    if (simulating) {
+        // Simulated jobs run exactly the virtual time they hold a CPU
+        long used_us = sim_now_us - cpu_seen_ns[slot] / 1000;
+        cpu_seen_ns[slot] = sim_now_us * 1000;
+        sim_remaining_us[slot] -= used_us;
+        return used_us;
+    }
+    if (dry_run || !has_clock[slot] || clock_gettime(job_clock[slot], &now) == -1) {
+        return time_slice * 1000L;
+    }
+    long long now_ns = (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+    long used_us = (now_ns - cpu_seen_ns[slot]) / 1000;
+    cpu_seen_ns[slot] = now_ns;
+    job_at(shared_queue, slot)->burst_time = now_ns / 1000000;
+    return used_us;
+}
+
+// Gangs are left free to spread their processes over the cores
+void pin_job(int slot, int cpu) {
+    if (pinned_cpu[slot] == cpu || dry_run || job_at(shared_queue, slot)->width > 1) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cores[cpu % n_cores], &set);
+    sched_setaffinity(job_at(shared_queue, slot)->pid, sizeof(set), &set);
+    pinned_cpu[slot] = cpu;
+}
+
+void run_on_cpu(int slot, int cpu) {
+    command *job = job_at(shared_queue, slot);
+    job->status = RUNNING;
+    job->cpu = cpu;
+    if (job->first_run_time == 0) job->first_run_time = scheduler_time_ms();
+    cpu_job[cpu] = slot;
+    cpu_since_us[cpu] = scheduler_time_us();
+    list_push_back(shared_queue, &on_cpu, slot);
+    pin_job(slot, cpu);
+    if (on_core[slot]) {
+        return;  // Taken off a CPU and picked again before it was stopped
+    }
+    signal_job(job, SIGCONT); // Signal to start/resume job
+    on_core[slot] = 1;
+    if (simulating) sim_job_started(slot);
+}
+
+int idle_cpus(int n_cpu) {
+    int idle = 0;
+    for (int cpu = 0; cpu < n_cpu; cpu++) {
+        if (cpu_job[cpu] == NO_JOB) idle++;
+    }
+    return idle;
+}
+
+// Start a gang on its width idle CPUs at once; it runs on the first of them
+// as far as the policy is concerned and holds the others
+void run_gang(int slot, int n_cpu) {
+    command *job = job_at(shared_queue, slot);
+    int first = NO_JOB, claimed = 0;
+    for (int cpu = 0; cpu < n_cpu && claimed < job->width; cpu++) {
+        if (cpu_job[cpu] != NO_JOB) continue;
+        if (claimed++ == 0) {
+            first = cpu;
+        } else {
+            cpu_job[cpu] = slot;
+            cpu_since_us[cpu] = scheduler_time_us();
+        }
+    }
+    run_on_cpu(slot, first);
+}
+
+// Give every idle CPU a job from the policy. A gang is started only after
+// the other idle CPUs have taken the plain jobs waiting for them, so it
+// cannot keep them out by grabbing every CPU at each boundary; one that no
+// longer fits is held in pending_gang, off the policy's lists, and no other
+// job is started until it does. The next slice boundary makes room.
+void dispatch_jobs(int n_cpu) {
+    if (pending_gang != NO_JOB) {
+        if (idle_cpus(n_cpu) < job_at(shared_queue, pending_gang)->width) return;
+        run_gang(pending_gang, n_cpu);
+        pending_gang = NO_JOB;
+    }
+    int gang = NO_JOB;
+    for (int cpu = 0; cpu < n_cpu; cpu++) {
+        if (cpu_job[cpu] != NO_JOB) continue;
+        int slot = policy->pick_next(cpu);
+        if (slot == NO_JOB) continue;
+        if (job_at(shared_queue, slot)->width <= 1) {
+            run_on_cpu(slot, cpu);
+        } else if (gang == NO_JOB) {
+            gang = slot;
+        } else {
+            policy->requeue(slot, false);  // One gang per dispatch
+        }
+    }
+    if (gang == NO_JOB) return;
+    if (idle_cpus(n_cpu) >= job_at(shared_queue, gang)->width) {
+        run_gang(gang, n_cpu);
+    } else {
+        pending_gang = gang;
+    }
+}
+
+// Take a job off its CPU and hand it back to the policy. It keeps running
+// until flush_stops(), so a job that is picked again straight away, e.g.
+// because it is alone on its CPU, is never stopped and resumed.
+void vacate_job(int slot, bool expired) {
+    command *job = job_at(shared_queue, slot);
+    job->status = READY;
+    list_remove(shared_queue, &on_cpu, slot);
+    release_cpus(slot);
+    policy->requeue(slot, expired);
+    if (!is_vacated[slot]) {
+        is_vacated[slot] = 1;
+        vacated[n_vacated++] = slot;
+    }
+}
+
+void flush_stops() {
+    for (int i = 0; i < n_vacated; i++) {
+        int slot = vacated[i];
+        command *job = job_at(shared_queue, slot);
+        is_vacated[slot] = 0;
+        if (job->status == READY && on_core[slot]) {
+            signal_job(job, SIGSTOP);
+            on_core[slot] = 0;
+            if (simulating) sim_job_stopped(slot);
+        }
+    }
+    n_vacated = 0;
+}
+
+void arm_slice_timer(int time_slice) {
+    // Slices are laid end to end on absolute deadlines so they never drift;
+    // after an idle gap the next one starts from now
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long long deadline_ns = (long long)slice_deadline.tv_sec * 1000000000LL + slice_deadline.tv_nsec;
+    long long now_ns = (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+    if (deadline_ns < now_ns) deadline_ns = now_ns;
+    deadline_ns += (long long)time_slice * 1000000LL;
+    slice_deadline.tv_sec = deadline_ns / 1000000000LL;
+    slice_deadline.tv_nsec = deadline_ns % 1000000000LL;
+
+    struct itimerspec timer = { .it_value = slice_deadline };
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &timer, NULL);
+    slice_active = true;
+}
+
+void slice_boundary(int n_cpu, int time_slice, long now) {
+    long long started_ns = monotonic_ns();
+    long long started_us = scheduler_time_us();
+    stats.slices++;
+    policy->periodic(now);
+
+    // Charge the slice and take the jobs whose quantum ran out off their CPUs
+    int slot = on_cpu.head;
+    while (slot != NO_JOB) {
+        command *job = job_at(shared_queue, slot);
+        int next = job->next;
+        cpu_since_us[job->cpu] = started_us;
+        adapt_expired++;
+        if (policy->charge(slot, job_cpu_used_us(slot, time_slice))) {
+            vacate_job(slot, true);
+        }
+        slot = next;
+    }
+    // A gang waiting for CPUs gets them all at the boundary
+    if (pending_gang != NO_JOB) {
+        while (on_cpu.head != NO_JOB) {
+            vacate_job(on_cpu.head, false);
+        }
+    }
+    dispatch_jobs(n_cpu);
 
-    // Update the last node of the moved part to NULL
-    current->next = NULL;
+    // Let waiting jobs of a higher priority take over from running ones
+    int victim;
+    while ((victim = policy->victim()) != NO_JOB) {
+        vacate_job(victim, false);
+        dispatch_jobs(n_cpu);
+    }
+    flush_stops();
 
-    // Traverse to the end of the list
-    command* end = new_head;
-    while (end->next != NULL) {
-        end = end->next;
+    // Simulated boundaries send no signals, their cost would mean nothing
+    if (options.adapt_max_ms > 0 && !simulating) {
+        double cost_ns = monotonic_ns() - started_ns;
+        boundary_cost_ns = boundary_cost_ns == 0 ? cost_ns : boundary_cost_ns * 7 / 8 + cost_ns / 8;
     }
+}
 
-    // Attach the first part to the end
-    end->next = head;
+void end_slice(int n_cpu, int time_slice) {
+    uint64_t expirations;
+    ssize_t got = read(timer_fd, &expirations, sizeof(expirations));
+    (void)got;
+    slice_active = false;
+    slice_boundary(n_cpu, time_slice, get_current_time_ms());
+    adapt_quantum(n_cpu, get_current_time_ms());
+}
 
-    // Update the head pointer to the new head
-    head = new_head;
+// A job's pidfd fired: give its CPU to the next job instead of idling
+// until the slice ends. The shell still posts the completion event.
+void job_exited(int slot, int fd) {
+    struct pollfd check = { .fd = fd, .events = POLLIN };
+    if (job_pidfds[slot] != fd || poll(&check, 1, 0) != 1) {
+        return;  // Stale event for a slot that was already recycled
+    }
+    drop_job(slot);
 }
 
+// Copy the counters and the CPUs' jobs to the shared table for the shell
+void publish_stats() {
+    stats.updated_ms = get_current_time_ms();
+    stats.running_jobs = on_cpu.count;
+    stats.ready_jobs = atomic_load(&shared_queue->number_of_jobs) - on_cpu.count;
+    stats.n_cpus = n_cpus < STATS_MAX_CPUS ? n_cpus : STATS_MAX_CPUS;
+    for (int cpu = 0; cpu < stats.n_cpus; cpu++) {
+        stats.cpu_pid[cpu] = cpu_job[cpu] == NO_JOB ? 0 : job_at(shared_queue, cpu_job[cpu])->pid;
+    }
+    stats_publish(shared_queue, &stats);
+}
 
 void start_scheduler(int n_cpu, int time_slice) {
-    long current_time;
-    bool jobs_available = true;
+    struct epoll_event events[64];
 
+    setup_event_loop();
+    publish_stats();
     while (true)
     {
+        // Sleeps until a submission, a completion or the end of the slice,
+        // or briefly while signals are still to be confirmed
+        int ready = epoll_wait(epoll_fd, events, 64, n_probes > 0 ? PROBE_RETRY_MS : -1);
+        if (ready == -1) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait failed");
+            exit(1);
+        }
+        if (ready == 0) {
+            confirm_signals();
+            publish_stats();
+            continue;
+        }
+        long long woke_ns = monotonic_ns();
 
-        if ((*number_of_jobs) > 0)
-        {
-            int running_jobs = 0;
-            command* job;
-            // Process up to NCPU jobs
-            for (int i = 0; i < n_cpu && i != (*number_of_jobs); i++) {
-                command *job = get_next_job();
-                if(job == NULL){
-                    printf("No more job available.\n");
-                    break;
-                }
-                printf("found job\n");
-                printf("job pid %d\n",job->pid);
-                if (job && job->status == READY) {
-                    printf("signal1\n");
-                    kill(job->pid, SIGCONT); // Signal to start/resume job
-                    printf("signal2\n");
-                    job->status = RUNNING;
-                    running_jobs++;
-                }
+        for (int i = 0; i < ready; i++) {
+            int source = (int32_t)(events[i].data.u64 >> 32);
+            int fd = (int32_t)(uint32_t)events[i].data.u64;
+            if (source == WAKEUP_SOURCE) {
+                drain_job_events();
+            } else if (source == TIMER_SOURCE) {
+                end_slice(n_cpu, quantum_ms);
+            } else {
+                job_exited(source, fd);
             }
+        }
+
+        dispatch_jobs(n_cpu);
+        if (!slice_active && on_cpu.count > 0) {
+            arm_slice_timer(quantum_ms);
+        }
+        stats.wakeups++;
+        stats.loop_ns += monotonic_ns() - woke_ns;
+        confirm_signals();
+        publish_stats();
+    }
+}
+
+// -b: time the per-slice work of every policy on a private table holding
+// the given number of queued jobs. The jobs are never signalled and get pids
+// above any real pid_max just in case.
+#define BENCH_SLICES 20000
+#define BENCH_PID_BASE 0x40000000
+
+void run_benchmark(int n_cpu, int time_slice, int jobs) {
+    dry_run = true;
+    printf("%-6s %8s %8s %14s %14s\n", "policy", "jobs", "slices", "ns/slice", "signals/slice");
+    for (int p = 0; policies[p] != NULL; p++) {
+        policy = policies[p];
+        shared_queue_bytes = shared_queue_size(jobs);
+        shared_queue = mmap(NULL, shared_queue_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (shared_queue == MAP_FAILED) {
+            perror("Benchmark table mapping failed");
+            exit(1);
+        }
+        job_table_init(shared_queue, jobs, -1);
+        job_slots = jobs;
+        setup_cpus(n_cpu, jobs);
+        reset_policy_state(0);
+        init_quantum(0);
+
+        for (int i = 0; i < jobs; i++) {
+            int slot = job_alloc(shared_queue);
+            command *job = job_at(shared_queue, slot);
+            memset(job, 0, sizeof(command));
+            job->pid = BENCH_PID_BASE + slot;
+            job->status = READY;
+            job->priority = 1 + i % 4;
+            job->heap_index = -1;
+            job->next = job->prev = NO_JOB;
+            policy->admit(slot);
+        }
+        dispatch_jobs(n_cpu);
+        stats.sigstops = stats.sigconts = 0;
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (long slice = 1; slice <= BENCH_SLICES; slice++) {
+            slice_boundary(n_cpu, time_slice, slice * time_slice);
+            dispatch_jobs(n_cpu);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+        printf("%-6s %8d %8d %14.1f %14.2f\n", policy->name, jobs, BENCH_SLICES, ns / BENCH_SLICES,
+               (double)(stats.sigstops + stats.sigconts) / BENCH_SLICES);
+        munmap(shared_queue, shared_queue_bytes);
+        free_cpus();
+    }
+}
+
+// -s: discrete-event simulation. A trace of "arrival_ms burst_ms [priority]
+// [est=ms] [deadline=ms]" lines, sorted by arrival, is played through the
+// real policy and dispatch code on a virtual clock. Without est= a job's
+// estimate is its exact burst. Events wait in a min-heap; a completion event is
+// invalidated by bumping its slot's version when the job is stopped early.
+#define SIM_DEFAULT_CAPACITY 65536
+
+enum { SIM_COMPLETION, SIM_ARRIVAL, SIM_SLICE };  // Order of events due at the same time
+
+typedef struct sim_event {
+    long long time_us;
+    int type;
+    int slot;
+    unsigned int version;
+} sim_event;
+
+sim_event *sim_heap;
+int sim_heap_count, sim_heap_capacity;
+unsigned int *sim_version;
+long long *sim_arrival_us;
+long long *sim_burst_us;
+
+// Growable array of per-job results in seconds
+typedef struct sim_samples {
+    double *values;
+    long count, capacity;
+} sim_samples;
+
+bool sim_event_before(sim_event *a, sim_event *b) {
+    return a->time_us < b->time_us || (a->time_us == b->time_us && a->type < b->type);
+}
+
+void sim_push(long long time_us, int type, int slot) {
+    if (sim_heap_count == sim_heap_capacity) {
+        sim_heap_capacity = sim_heap_capacity ? sim_heap_capacity * 2 : 1024;
+        sim_heap = realloc(sim_heap, sizeof(sim_event) * sim_heap_capacity);
+        if (sim_heap == NULL) {
+            perror("Simulator event heap allocation failed");
+            exit(1);
+        }
+    }
+    sim_event event = { time_us, type, slot, slot >= 0 ? sim_version[slot] : 0 };
+    int index = sim_heap_count++;
+    while (index > 0 && sim_event_before(&event, &sim_heap[(index - 1) / 2])) {
+        sim_heap[index] = sim_heap[(index - 1) / 2];
+        index = (index - 1) / 2;
+    }
+    sim_heap[index] = event;
+}
+
+sim_event sim_pop() {
+    sim_event top = sim_heap[0];
+    sim_event last = sim_heap[--sim_heap_count];
+    int index = 0;
+    for (;;) {
+        int child = 2 * index + 1;
+        if (child >= sim_heap_count) break;
+        if (child + 1 < sim_heap_count && sim_event_before(&sim_heap[child + 1], &sim_heap[child])) child++;
+        if (!sim_event_before(&sim_heap[child], &last)) break;
+        sim_heap[index] = sim_heap[child];
+        index = child;
+    }
+    sim_heap[index] = last;
+    return top;
+}
+
+void sim_job_started(int slot) {
+    cpu_seen_ns[slot] = sim_now_us * 1000;
+    if (sim_first_run_us[slot] < 0) sim_first_run_us[slot] = sim_now_us;
+    sim_push(sim_now_us + sim_remaining_us[slot], SIM_COMPLETION, slot);
+}
 
-            usleep(time_slice * 1000);
-
-            command *temp = shared_queue->head;
-            int j = 0;
-            // Calculate completion and waiting time
-            while(temp != NULL && j<=running_jobs){
-                if (temp && temp->status == RUNNING) {
-                    kill(temp->pid, SIGSTOP);
-                    temp->status = READY;
-                    temp->burst_time += time_slice;
-                    j++;
+void sim_job_stopped(int slot) {
+    sim_remaining_us[slot] -= sim_now_us - cpu_seen_ns[slot] / 1000;
+    sim_version[slot]++;
+}
+
+void sim_record(sim_samples *samples, double value) {
+    if (samples->count == samples->capacity) {
+        samples->capacity = samples->capacity ? samples->capacity * 2 : 4096;
+        samples->values = realloc(samples->values, sizeof(double) * samples->capacity);
+        if (samples->values == NULL) {
+            perror("Simulator result allocation failed");
+            exit(1);
+        }
+    }
+    samples->values[samples->count++] = value;
+}
+
+int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+void sim_print_distribution(const char *label, sim_samples *samples) {
+    if (samples->count == 0) return;
+    qsort(samples->values, samples->count, sizeof(double), compare_doubles);
+    double sum = 0;
+    for (long i = 0; i < samples->count; i++) sum += samples->values[i];
+    double *v = samples->values;
+    long n = samples->count;
+    printf("%-12s %12.3f %12.3f %12.3f %12.3f %12.3f\n", label, sum / n,
+           v[(n * 50 + 99) / 100 - 1], v[(n * 95 + 99) / 100 - 1], v[(n * 99 + 99) / 100 - 1], v[n - 1]);
+}
+
+// The hints after the priority, as in submit: est=ms and deadline=ms, the
+// latter at least 1 ms so that 0 can stand for no deadline
+bool sim_parse_hint(const char *token, double *est_ms, double *deadline_ms) {
+    char *end;
+    double *target = strncmp(token, "est=", 4) == 0 ? est_ms : strncmp(token, "deadline=", 9) == 0 ? deadline_ms : NULL;
+    if (target == NULL) return false;
+    const char *value = strchr(token, '=') + 1;
+    *target = strtod(value, &end);
+    return end != value && *end == '\0' && *target >= (target == deadline_ms ? 1 : 0);
+}
+
+// Read the next trace record; returns 0 at the end of the trace. est_ms and
+// deadline_ms are -1 when the record has no such hint.
+int sim_next_arrival(FILE *trace, long *line_number, double *arrival_ms, double *burst_ms, int *priority,
+                     double *est_ms, double *deadline_ms) {
+    char *line = NULL;
+    size_t len = 0;
+    int found = 0;
+    while (!found && getline(&line, &len, trace) != -1) {
+        (*line_number)++;
+        char *start = line + strspn(line, " \t");
+        if (*start == '\n' || *start == '\0' || *start == '#') continue;
+        *priority = DEFAULT_PRIORITY;
+        *est_ms = -1;
+        *deadline_ms = -1;
+        int used = 0, fields = sscanf(start, "%lf %lf%n %d%n", arrival_ms, burst_ms, &used, priority, &used);
+        bool valid = fields >= 2 && *arrival_ms >= 0 && *burst_ms >= 0 && *priority >= 1 && *priority <= MLFQ_MAX_LEVELS;
+        char *saveptr;
+        for (char *token = strtok_r(start + used, " \t\n", &saveptr); valid && token != NULL;
+             token = strtok_r(NULL, " \t\n", &saveptr)) {
+            valid = sim_parse_hint(token, est_ms, deadline_ms);
+        }
+        if (!valid) {
+            fprintf(stderr, "Trace line %ld: expected arrival_ms burst_ms [priority 1-%d] [est=ms] [deadline=ms]\n",
+                    *line_number, MLFQ_MAX_LEVELS);
+            exit(1);
+        }
+        found = 1;
+    }
+    free(line);
+    return found;
+}
+
+void run_simulation(int n_cpu, int time_slice, const char *path, int capacity) {
+    FILE *trace = fopen(path, "r");
+    if (trace == NULL) {
+        perror(path);
+        exit(1);
+    }
+    dry_run = true;
+    simulating = true;
+    shared_queue_bytes = shared_queue_size(capacity);
+    shared_queue = mmap(NULL, shared_queue_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (shared_queue == MAP_FAILED) {
+        perror("Simulator table mapping failed");
+        exit(1);
+    }
+    job_table_init(shared_queue, capacity, -1);
+    job_slots = capacity;
+    setup_cpus(n_cpu, capacity);
+    reset_policy_state(0);
+    init_quantum(0);
+    sim_remaining_us = alloc_or_die(sizeof(long long) * capacity);
+    sim_first_run_us = alloc_or_die(sizeof(long long) * capacity);
+    sim_arrival_us = alloc_or_die(sizeof(long long) * capacity);
+    sim_burst_us = alloc_or_die(sizeof(long long) * capacity);
+    sim_version = alloc_or_die(sizeof(unsigned int) * capacity);
+
+    sim_samples turnaround = { 0 }, wait = { 0 }, response = { 0 }, slowdown = { 0 };
+    long line_number = 0, deadlines = 0, missed = 0;
+    double arrival_ms, burst_ms, est_ms, deadline_ms, last_arrival_ms = 0;
+    int priority;
+    long long next_slice_us = 0, last_exit_us = 0;
+    sim_now_us = 0;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (sim_next_arrival(trace, &line_number, &arrival_ms, &burst_ms, &priority, &est_ms, &deadline_ms)) {
+        sim_push((long long)(arrival_ms * 1000), SIM_ARRIVAL, -1);
+    }
+
+    while (sim_heap_count > 0) {
+        sim_event event = sim_pop();
+        sim_now_us = event.time_us;
+
+        if (event.type == SIM_ARRIVAL) {
+            int slot = job_alloc(shared_queue);
+            if (slot == NO_JOB) {
+                fprintf(stderr, "More than %d jobs in the system at %.3f s, raise MAX_JOBS\n", capacity, sim_now_us / 1e6);
+                exit(1);
+            }
+            command *job = job_at(shared_queue, slot);
+            memset(job, 0, sizeof(command));
+            job->pid = BENCH_PID_BASE + slot;
+            job->status = READY;
+            job->priority = priority;
+            job->heap_index = -1;
+            job->next = job->prev = NO_JOB;
+            job->start_time = sim_now_us / 1000;
+            sim_arrival_us[slot] = sim_now_us;
+            sim_burst_us[slot] = (long long)(burst_ms * 1000) > 0 ? (long long)(burst_ms * 1000) : 1;
+            job->remaining_time = est_ms >= 0 ? (long)(est_ms * 1000) : sim_burst_us[slot];
+            job->deadline = deadline_ms >= 0 ? (long)(arrival_ms + deadline_ms) : 0;
+            sim_remaining_us[slot] = sim_burst_us[slot];
+            sim_first_run_us[slot] = -1;
+            admit_job(slot);
+
+            last_arrival_ms = arrival_ms;
+            if (sim_next_arrival(trace, &line_number, &arrival_ms, &burst_ms, &priority, &est_ms, &deadline_ms)) {
+                if (arrival_ms < last_arrival_ms) {
+                    fprintf(stderr, "Trace line %ld: arrivals must be sorted by time\n", line_number);
+                    exit(1);
                 }
-                temp = temp->next;
-            }     
-            move_n_nodes_to_end(shared_queue->head,n_cpu);
-        }    
+                sim_push((long long)(arrival_ms * 1000), SIM_ARRIVAL, -1);
+            }
+        } else if (event.type == SIM_SLICE) {
+            slice_active = false;
+            slice_boundary(n_cpu, quantum_ms, sim_now_us / 1000);
+            adapt_quantum(n_cpu, sim_now_us / 1000);
+        } else {
+            int slot = event.slot;
+            if (event.version != sim_version[slot] || job_at(shared_queue, slot)->status != RUNNING) {
+                continue;  // The job was stopped before this completion came due
+            }
+            drop_job(slot);
+            atomic_fetch_sub(&shared_queue->number_of_jobs, 1);
+            sim_version[slot]++;
+            last_exit_us = sim_now_us;
+            stats.completed++;
+            double turnaround_s = (sim_now_us - sim_arrival_us[slot]) / 1e6;
+            sim_record(&turnaround, turnaround_s);
+            sim_record(&wait, turnaround_s - sim_burst_us[slot] / 1e6);
+            sim_record(&response, (sim_first_run_us[slot] - sim_arrival_us[slot]) / 1e6);
+            sim_record(&slowdown, bounded_slowdown((sim_now_us - sim_arrival_us[slot]) / 1e3, sim_burst_us[slot] / 1e3));
+            command *job = job_at(shared_queue, slot);
+            if (job->deadline > 0) {
+                deadlines++;
+                if (sim_now_us > job->deadline * 1000LL) missed++;
+            }
+            job_free(shared_queue, slot);
+        }
+
+        dispatch_jobs(n_cpu);
+        if (!slice_active && on_cpu.count > 0) {
+            // Same end-to-end slices as arm_slice_timer
+            if (next_slice_us < sim_now_us) next_slice_us = sim_now_us;
+            next_slice_us += quantum_ms * 1000LL;
+            sim_push(next_slice_us, SIM_SLICE, -1);
+            slice_active = true;
+        }
     }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    fclose(trace);
+
+    double real_s = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    double makespan_s = last_exit_us / 1e6;
+    printf("Simulated %ld jobs with %s on %d CPUs, TSLICE %d ms\n", turnaround.count, policy->name, n_cpu, time_slice);
+    printf("Makespan       %.3f s\n", makespan_s);
+    printf("Throughput     %.2f jobs/s\n", makespan_s > 0 ? turnaround.count / makespan_s : 0);
+    printf("Signals        %ld SIGSTOP, %ld SIGCONT\n", stats.sigstops, stats.sigconts);
+    printf("%-12s %12s %12s %12s %12s %12s\n", "seconds", "mean", "p50", "p95", "p99", "max");
+    sim_print_distribution("Turnaround", &turnaround);
+    sim_print_distribution("Wait", &wait);
+    sim_print_distribution("Response", &response);
+    printf("%-12s %12s %12s %12s %12s %12s\n", "ratio", "mean", "p50", "p95", "p99", "max");
+    sim_print_distribution("Slowdown", &slowdown);
+    if (deadlines > 0) printf("Deadlines      %ld of %ld missed\n", missed, deadlines);
+    print_quantum_history(&stats);
+    printf("Simulation took %.3f s of real time\n", real_s);
 }
 
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        fprintf(stderr, "Usage: %s <NCPU> <TSLICE>\n", argv[0]);
+    if (parse_sched_options(argc, argv, &options) == -1 || (argc - optind != 2 && argc - optind != 3)) {
+        fprintf(stderr, "Usage: %s [-P rr|mlfq|cfs|srtf|edf] [-L levels] [-B boost_ms] [-A min:max] [-l] [-b jobs] [-s trace] <NCPU> <TSLICE> [MAX_JOBS]\n", argv[0]);
         exit(1);
     }
-    NCPU = atoi(argv[1]);
-    TSLICE = atoi(argv[2]);
+    NCPU = atoi(argv[optind]);
+    TSLICE = atoi(argv[optind + 1]);
     if(NCPU<=0 || TSLICE<=0){
         printf("Number of CPU's and time quantum should be positive integers.");
         exit(0);
     }
-    printf("in sched\n");
+    for (int i = 0; policies[i] != NULL; i++) {
+        if (strcmp(policies[i]->name, options.policy) == 0) policy = policies[i];
+    }
+    if (options.bench_jobs > ARENA_MAX_JOBS) {
+        fprintf(stderr, "At most %d jobs fit in the table\n", ARENA_MAX_JOBS);
+        exit(1);
+    }
+    if (options.bench_jobs > 0) {
+        run_benchmark(NCPU, TSLICE, options.bench_jobs);
+        return 0;
+    }
+    if (options.trace_path != NULL) {
+        int capacity = argc - optind == 3 ? atoi(argv[optind + 2]) : SIM_DEFAULT_CAPACITY;
+        if (capacity <= 0 || capacity > ARENA_MAX_JOBS) capacity = SIM_DEFAULT_CAPACITY;
+        run_simulation(NCPU, TSLICE, options.trace_path, capacity);
+        return 0;
+    }
     //signal(SIGTERM, handle_scheduler_termination);
     reconnect_resources_after_exec();
     start_scheduler(NCPU, TSLICE);
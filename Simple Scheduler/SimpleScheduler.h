@@ -5,42 +5,536 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #define SHM_KEY 0x1234
-#define SEM_KEY 0x5678
-#define MAX_JOBS 100
+#define MAX_JOBS 100             // Default initial job table capacity
+#define ARENA_MAX_JOBS (1 << 20) // The table grows up to this many slots
+#define NO_JOB -1                // Empty slot index / end of a job list
+#define EVENT_RING_SIZE 1024     // Pending submissions/completions, power of two
+#define MLFQ_MAX_LEVELS 8        // Upper bound for -L and for submit priorities
+#define DEFAULT_PRIORITY 1       // 1 is the highest priority
+#define DEFAULT_POOL_SIZE 16     // Parked launchers the shell keeps ready
+#define MAX_JOB_ARGS 64          // Arguments of one submitted job, name included
+#define MAX_SPEC_BYTES 4096      // Their total size, NULs included
+#define QUANTUM_HISTORY 16       // Adaptive quantum changes kept for the statistics
+#define STATS_MAX_CPUS 64        // CPUs listed in the statistics page
+#define SLOWDOWN_MIN_MS 10       // Shorter runs count as this long in slowdowns
+#define LATENCY_BUCKETS 24       // Signal latency histogram: bucket b counts [2^b, 2^(b+1)) us
+#define SCHED_OPTIONS "P:L:B:A:b:s:z:l" // Options the shell forwards to the scheduler
 
-typedef enum { READY, RUNNING, COMPLETED } JobStatus;
+typedef enum { READY, RUNNING, COMPLETED, FREE } JobStatus;
 
 typedef struct command {
     pid_t pid;                   // Process ID of the job
-    char* name[256];              // Job name
-    int burst_time;              // Total execution time required by the job
-    int wait_time;               // Total waiting time
-    int remaining_time;
-    int completion_time;         // Total completion time
-    int start_time;              // Time when the job was added to the queue
-    int end_time;                // Time when the job completes
-    int status;                  // Job status: READY, RUNNING, COMPLETED
-    struct command *next;        // Pointer to the next job in the queue
+    char name[256];              // Job name
+    int burst_time;              // ms of CPU the job has used so far, from its CPU clock
+    int wait_time;               // Turnaround minus CPU time
+    long remaining_time;         // us of CPU left of the est= estimate, -1 without one
+    long deadline;               // Time the job should have finished by, 0 without one
+    int completion_time;         // Turnaround time: submission to exit
+    int response_time;           // Submission to first run
+    int cpu_time;                // Exact CPU time (user + system) from wait4
+    long context_switches;       // Voluntary + involuntary, from wait4
+    long start_time;             // Time when the job was added to the queue
+    long first_run_time;         // Time the scheduler first resumed the job, 0 before
+    long end_time;               // Time when the job completes
+    int status;                  // Job status: READY, RUNNING, COMPLETED, FREE
+    int priority;                // 1 (highest) .. MLFQ_MAX_LEVELS, from submit
+    int level;                   // MLFQ queue the job currently belongs to
+    long quantum_used;           // us of CPU spent in the current level's quantum
+    long vruntime;               // CFS virtual runtime, us of CPU scaled by the job's weight
+    int heap_index;              // Position in the run heap while READY
+    int cpu;                     // CPU the job last ran on; its run queue under rr
+    int width;                   // CPUs a gang holds in the same slice, 0 or 1 for one
+    int next;                    // Slot of the next job on the same list
+    int prev;                    // Slot of the previous job on the same list
 } command;
 
-typedef struct Shared_queue{
-    command* head;
-    command* tail;    
+typedef struct job_list {
+    int head;
+    int tail;
+    int count;
+} job_list;
+
+// A batch event carries the first slot of a chain linked through next
+typedef enum { JOB_SUBMITTED, JOB_COMPLETED, JOB_BATCH_SUBMITTED } job_event_type;
+
+// One cell of the event ring; sequence tells producers and the consumer
+// whose turn it is to use the cell
+typedef struct job_event {
+    atomic_uint sequence;
+    int type;
+    int slot;
+} job_event;
+
+// Bounded lock-free multi-producer, single-consumer ring. The shell and its
+// SIGCHLD handler produce, the scheduler drains it at the start of a slice
+typedef struct event_ring {
+    atomic_uint head;            // Next cell a producer claims
+    atomic_uint tail;            // Next cell the scheduler reads
+    job_event cells[EVENT_RING_SIZE];
+} event_ring;
+
+// One change of the adaptive quantum, ms since the scheduler started
+typedef struct quantum_change {
+    long time_ms;
+    int quantum_ms;
+} quantum_change;
+
+// What the scheduler publishes for the stats command. Counters run from the
+// scheduler's start; times are ms of CLOCK_MONOTONIC.
+typedef struct sched_stats {
+    long started_ms;             // When the scheduler started
+    long updated_ms;             // When this copy was published
+    int ready_jobs;              // Queue depth: admitted jobs waiting for a CPU
+    int running_jobs;
+    int n_cpus;                  // Entries of cpu_pid in use, NCPU up to STATS_MAX_CPUS
+    pid_t cpu_pid[STATS_MAX_CPUS]; // Job on each CPU, 0 when idle
+    long slices;                 // Slice boundaries handled
+    long sigstops;
+    long sigconts;
+    long wakeups;                // Times the event loop woke up
+    long long loop_ns;           // Time spent handling those wakeups
+    long completed;              // Jobs that left the system
+    int quantum_ms;              // Time slice in effect
+    int adaptive;                // -A given, so the slice may change
+    unsigned int quantum_changes; // Changes so far, the last QUANTUM_HISTORY are kept
+    quantum_change quantum_history[QUANTUM_HISTORY];
+    long switch_in[LATENCY_BUCKETS];  // With -l: SIGCONT sent until the job ran
+    long switch_out[LATENCY_BUCKETS]; // SIGSTOP sent until the job was stopped
+    long probe_timeouts;         // Signals not seen to take effect within a slice or before the job's next one
+} sched_stats;
+
+// Job table living entirely in shared memory; jobs refer to each other by
+// slot index so both processes can follow the lists at any mapping address.
+// The run queue belongs to the scheduler, the shell only talks to it
+// through the event ring. The slots and the pid index after them come last
+// so the shell can grow the table in place.
+typedef struct Shared_queue {
+    int capacity;                // Number of slots in jobs[]
+    atomic_uint generation;      // Bumped by the shell after it grows the table
+    atomic_int number_of_jobs;   // Jobs the scheduler has admitted and not retired
+    _Atomic uint64_t free_slots; // Treiber stack of unused slots: ABA tag << 32 | slot
+    event_ring events;           // Submissions and completions for the scheduler
+    int wakeup_fd;               // eventfd the scheduler sleeps on, bumped after each post
+    int pid_index_size;          // Cells of the pid index, a power of two
+    atomic_uint stats_sequence;  // Seqlock over stats, odd while the scheduler writes
+    sched_stats stats;
+    command jobs[];              // capacity slots, then pid_index_size pid index cells
 } Shared_queue;
 
+// At most half full, so probes stay short
+static inline int pid_index_cells(int capacity) {
+    int cells = 1;
+    while (cells < 2 * capacity) cells <<= 1;
+    return cells;
+}
+
+static inline size_t shared_queue_size(int capacity) {
+    return sizeof(Shared_queue) + (size_t)capacity * sizeof(command) +
+           (size_t)pid_index_cells(capacity) * sizeof(atomic_int);
+}
+
+// Address space for the largest table, so growing never moves it; the shared
+// object is mapped over its start and remapped as it grows
+static inline Shared_queue *job_table_reserve() {
+    void *base = mmap(NULL, shared_queue_size(ARENA_MAX_JOBS), PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return base == MAP_FAILED ? NULL : base;
+}
+
+static inline int job_table_map(Shared_queue *base, int fd, int capacity) {
+    void *mapped = mmap(base, shared_queue_size(capacity), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    return mapped == MAP_FAILED ? -1 : 0;
+}
+
+static inline command *job_at(Shared_queue *queue, int slot) {
+    return slot == NO_JOB ? NULL : &queue->jobs[slot];
+}
+
+// Open-addressing hash from pid to slot with linear probing; a cell holds a
+// slot and the key is that slot's pid. The shell adds a job when its
+// launcher's pid is known and removes it when it reaps the job, with SIGCHLD
+// blocked while it adds, so there is a single writer at a time. The index
+// follows the slots, so it moves and is rebuilt whenever the table grows.
+static inline atomic_int *pid_index(Shared_queue *queue) {
+    return (atomic_int *)&queue->jobs[queue->capacity];
+}
+
+static inline unsigned int pid_hash(Shared_queue *queue, pid_t pid) {
+    return ((uint32_t)pid * 2654435761u) & (queue->pid_index_size - 1);
+}
+
+static inline void pid_index_add(Shared_queue *queue, int slot) {
+    atomic_int *index = pid_index(queue);
+    unsigned int mask = queue->pid_index_size - 1;
+    unsigned int cell = pid_hash(queue, queue->jobs[slot].pid);
+    while (atomic_load_explicit(&index[cell], memory_order_relaxed) != NO_JOB) {
+        cell = (cell + 1) & mask;
+    }
+    atomic_store_explicit(&index[cell], slot, memory_order_release);
+}
+
+// Cell holding the pid's slot, or -1
+static inline int pid_index_cell(Shared_queue *queue, pid_t pid) {
+    atomic_int *index = pid_index(queue);
+    unsigned int mask = queue->pid_index_size - 1;
+    for (unsigned int cell = pid_hash(queue, pid);; cell = (cell + 1) & mask) {
+        int slot = atomic_load_explicit(&index[cell], memory_order_acquire);
+        if (slot == NO_JOB) return -1;
+        if (queue->jobs[slot].pid == pid) return cell;
+    }
+}
+
+static inline int pid_index_lookup(Shared_queue *queue, pid_t pid) {
+    int cell = pid_index_cell(queue, pid);
+    return cell == -1 ? NO_JOB : atomic_load_explicit(&pid_index(queue)[cell], memory_order_relaxed);
+}
+
+// Backward-shift deletion: later cells of the probe run move into the hole
+// when their home allows it, so no tombstones pile up
+static inline void pid_index_remove(Shared_queue *queue, pid_t pid) {
+    atomic_int *index = pid_index(queue);
+    unsigned int mask = queue->pid_index_size - 1;
+    int hole = pid_index_cell(queue, pid);
+    if (hole == -1) return;
+    for (unsigned int cell = (hole + 1) & mask;; cell = (cell + 1) & mask) {
+        int slot = atomic_load_explicit(&index[cell], memory_order_relaxed);
+        if (slot == NO_JOB) break;
+        unsigned int home = pid_hash(queue, queue->jobs[slot].pid);
+        if (((cell - home) & mask) >= ((cell - hole) & mask)) {
+            atomic_store_explicit(&index[hole], slot, memory_order_release);
+            hole = cell;
+        }
+    }
+    atomic_store_explicit(&index[hole], NO_JOB, memory_order_release);
+}
+
+static inline void list_init(job_list *list) {
+    list->head = NO_JOB;
+    list->tail = NO_JOB;
+    list->count = 0;
+}
+
+static inline void list_push_back(Shared_queue *queue, job_list *list, int slot) {
+    command *job = &queue->jobs[slot];
+    job->next = NO_JOB;
+    job->prev = list->tail;
+    if (list->tail == NO_JOB) {
+        list->head = slot;
+    } else {
+        queue->jobs[list->tail].next = slot;
+    }
+    list->tail = slot;
+    list->count++;
+}
+
+static inline void list_remove(Shared_queue *queue, job_list *list, int slot) {
+    command *job = &queue->jobs[slot];
+    if (job->prev == NO_JOB) {
+        list->head = job->next;
+    } else {
+        queue->jobs[job->prev].next = job->next;
+    }
+    if (job->next == NO_JOB) {
+        list->tail = job->prev;
+    } else {
+        queue->jobs[job->next].prev = job->prev;
+    }
+    job->next = NO_JOB;
+    job->prev = NO_JOB;
+    list->count--;
+}
+
+static inline int list_pop_front(Shared_queue *queue, job_list *list) {
+    int slot = list->head;
+    if (slot != NO_JOB) list_remove(queue, list, slot);
+    return slot;
+}
+
+static inline uint64_t free_stack_word(uint64_t tag, int slot) {
+    return (tag << 32) | (uint32_t)slot;
+}
+
+// The shell allocates slots and the scheduler frees them, so the free list is
+// a tagged lock-free stack rather than a job_list
+static inline int job_alloc(Shared_queue *queue) {
+    uint64_t top = atomic_load(&queue->free_slots);
+    uint64_t next;
+    int slot;
+    do {
+        slot = (int32_t)(uint32_t)top;
+        if (slot == NO_JOB) return NO_JOB;
+        next = free_stack_word((top >> 32) + 1, queue->jobs[slot].next);
+    } while (!atomic_compare_exchange_weak(&queue->free_slots, &top, next));
+    return slot;
+}
+
+static inline void job_free(Shared_queue *queue, int slot) {
+    uint64_t top = atomic_load(&queue->free_slots);
+    queue->jobs[slot].status = FREE;
+    queue->jobs[slot].pid = 0;
+    do {
+        queue->jobs[slot].next = (int32_t)(uint32_t)top;
+    } while (!atomic_compare_exchange_weak(&queue->free_slots, &top, free_stack_word((top >> 32) + 1, slot)));
+}
+
+static inline void event_ring_init(event_ring *ring) {
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    for (unsigned int i = 0; i < EVENT_RING_SIZE; i++) {
+        atomic_init(&ring->cells[i].sequence, i);
+    }
+}
+
+// Returns 0 when the ring is full
+static inline int event_ring_push(event_ring *ring, int type, int slot) {
+    unsigned int pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    for (;;) {
+        job_event *cell = &ring->cells[pos & (EVENT_RING_SIZE - 1)];
+        unsigned int seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        int diff = (int)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                cell->type = type;
+                cell->slot = slot;
+                atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+                return 1;
+            }
+        } else if (diff < 0) {
+            return 0;
+        } else {
+            pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+    }
+}
+
+// The scheduler blocks in epoll until the eventfd is bumped; write() is
+// async-signal-safe so the SIGCHLD handler can call this too
+static inline void wake_scheduler(Shared_queue *queue) {
+    uint64_t one = 1;
+    ssize_t written = write(queue->wakeup_fd, &one, sizeof(one));
+    (void)written;
+}
+
+// Single consumer; returns 0 when nothing is published yet
+static inline int event_ring_pop(event_ring *ring, int *type, int *slot) {
+    unsigned int pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    job_event *cell = &ring->cells[pos & (EVENT_RING_SIZE - 1)];
+    unsigned int seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    if (seq != pos + 1) return 0;
+    *type = cell->type;
+    *slot = cell->slot;
+    atomic_store_explicit(&cell->sequence, pos + EVENT_RING_SIZE, memory_order_release);
+    atomic_store_explicit(&ring->tail, pos + 1, memory_order_relaxed);
+    return 1;
+}
+
+// Producers are never blocked by each other, only by a full ring, in which
+// case the scheduler is woken to make room
+static inline void event_ring_post(Shared_queue *queue, int type, int slot) {
+    while (!event_ring_push(&queue->events, type, slot)) {
+        wake_scheduler(queue);
+        sched_yield();
+    }
+    wake_scheduler(queue);
+}
+
+// The scheduler is the only writer; readers retry instead of blocking it
+static inline void stats_publish(Shared_queue *queue, const sched_stats *stats) {
+    unsigned int seq = atomic_load_explicit(&queue->stats_sequence, memory_order_relaxed);
+    atomic_store_explicit(&queue->stats_sequence, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    queue->stats = *stats;
+    atomic_store_explicit(&queue->stats_sequence, seq + 2, memory_order_release);
+}
+
+static inline void stats_read(Shared_queue *queue, sched_stats *stats) {
+    unsigned int before, after;
+    do {
+        before = atomic_load_explicit(&queue->stats_sequence, memory_order_acquire);
+        *stats = queue->stats;
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&queue->stats_sequence, memory_order_relaxed);
+    } while (before != after || (before & 1));
+}
+
+// Put slots [from, to) on the free list, lowest first
+static inline void job_table_add_slots(Shared_queue *queue, int from, int to) {
+    for (int i = to - 1; i >= from; i--) {
+        queue->jobs[i].next = NO_JOB;
+        queue->jobs[i].prev = NO_JOB;
+        job_free(queue, i);
+    }
+}
+
+// Lay out an empty table with every slot on the free list
+static inline void job_table_init(Shared_queue *queue, int capacity, int wakeup_fd) {
+    queue->capacity = capacity;
+    queue->wakeup_fd = wakeup_fd;
+    atomic_init(&queue->number_of_jobs, 0);
+    atomic_init(&queue->free_slots, free_stack_word(0, NO_JOB));
+    queue->pid_index_size = pid_index_cells(capacity);
+    for (int cell = 0; cell < queue->pid_index_size; cell++) {
+        atomic_init(&pid_index(queue)[cell], NO_JOB);
+    }
+    atomic_init(&queue->stats_sequence, 0);
+    memset(&queue->stats, 0, sizeof(queue->stats));
+    atomic_init(&queue->generation, 0);
+    event_ring_init(&queue->events);
+    job_table_add_slots(queue, 0, capacity);
+}
+
+
+// Scheduling options, given to the shell and forwarded to the scheduler
+typedef struct sched_options {
+    const char *policy;          // rr, mlfq, cfs, srtf or edf
+    int levels;                  // MLFQ levels, level k has a quantum of TSLICE << k
+    int boost_ms;                // MLFQ priority boost period, 0 for 50 slices
+    int adapt_min_ms;            // Adaptive quantum bounds, both 0 for a fixed TSLICE
+    int adapt_max_ms;
+    int bench_jobs;              // Scheduler only: benchmark this many queued jobs
+    const char *trace_path;      // Scheduler only: simulate this trace
+    int pool_size;               // Shell only: pre-forked launchers, 0 to fork per job
+    int probe_signals;           // Scheduler only: time each signal until /proc shows its effect
+} sched_options;
+
+static const char *const policy_names[] = { "rr", "mlfq", "cfs", "srtf", "edf", NULL };
+
+// Parse the options in front of NCPU and TSLICE; returns 0 and leaves optind
+// at the first positional argument, or prints the problem and returns -1
+static inline int parse_sched_options(int argc, char *argv[], sched_options *options) {
+    options->policy = "rr";
+    options->levels = 3;
+    options->boost_ms = 0;
+    options->adapt_min_ms = 0;
+    options->adapt_max_ms = 0;
+    options->bench_jobs = 0;
+    options->trace_path = NULL;
+    options->pool_size = DEFAULT_POOL_SIZE;
+    options->probe_signals = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, SCHED_OPTIONS)) != -1) {
+        switch (opt) {
+            case 'P':
+                options->policy = NULL;
+                for (int i = 0; policy_names[i] != NULL; i++) {
+                    if (strcmp(optarg, policy_names[i]) == 0) options->policy = policy_names[i];
+                }
+                if (options->policy == NULL) {
+                    fprintf(stderr, "Unknown scheduling policy: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'L':
+                options->levels = atoi(optarg);
+                if (options->levels <= 0 || options->levels > MLFQ_MAX_LEVELS) {
+                    fprintf(stderr, "MLFQ levels should be between 1 and %d\n", MLFQ_MAX_LEVELS);
+                    return -1;
+                }
+                break;
+            case 'B':
+                options->boost_ms = atoi(optarg);
+                if (options->boost_ms <= 0) {
+                    fprintf(stderr, "Boost period should be a positive number of ms\n");
+                    return -1;
+                }
+                break;
+            case 'A':
+                if (sscanf(optarg, "%d:%d", &options->adapt_min_ms, &options->adapt_max_ms) != 2 ||
+                    options->adapt_min_ms <= 0 || options->adapt_max_ms < options->adapt_min_ms) {
+                    fprintf(stderr, "Adaptive quantum bounds should be min:max in ms, 0 < min <= max\n");
+                    return -1;
+                }
+                break;
+            case 'b':
+                options->bench_jobs = atoi(optarg);
+                if (options->bench_jobs <= 0) {
+                    fprintf(stderr, "Benchmark job count should be a positive integer\n");
+                    return -1;
+                }
+                break;
+            case 's':
+                options->trace_path = optarg;
+                break;
+            case 'z':
+                options->pool_size = atoi(optarg);
+                if (options->pool_size < 0) {
+                    fprintf(stderr, "Launcher pool size should not be negative\n");
+                    return -1;
+                }
+                break;
+            case 'l':
+                options->probe_signals = 1;
+                break;
+            default:
+                return -1;
+        }
+    }
+    return 0;
+}
+
+// The quantum in effect and how it got there, oldest change first; nothing
+// without -A, when the slice never changes
+static inline void print_quantum_history(const sched_stats *stats) {
+    if (!stats->adaptive || stats->quantum_changes == 0) return;
+    printf("Time slice now %d ms after %u change%s\n", stats->quantum_ms, stats->quantum_changes - 1,
+           stats->quantum_changes == 2 ? "" : "s");
+    unsigned int first = stats->quantum_changes > QUANTUM_HISTORY ? stats->quantum_changes - QUANTUM_HISTORY : 0;
+    for (unsigned int i = first; i < stats->quantum_changes; i++) {
+        const quantum_change *change = &stats->quantum_history[i % QUANTUM_HISTORY];
+        printf("  at %8.3f s: %d ms\n", change->time_ms / 1000.0, change->quantum_ms);
+    }
+}
+
+// Turnaround over run time, with runs shorter than SLOWDOWN_MIN_MS counted
+// as that long so that tiny jobs do not dominate the average
+static inline double bounded_slowdown(double turnaround_ms, double run_ms) {
+    double slowdown = turnaround_ms / (run_ms > SLOWDOWN_MIN_MS ? run_ms : SLOWDOWN_MIN_MS);
+    return slowdown > 1 ? slowdown : 1;
+}
+
+static inline void latency_record(long *buckets, long long latency_ns) {
+    long long us = latency_ns / 1000;
+    int bucket = 0;
+    while (us > 1 && bucket < LATENCY_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    buckets[bucket]++;
+}
+
+// Upper bound of the bucket holding the p-th percentile, in us
+static inline long latency_percentile(const long *buckets, long count, int p) {
+    long rank = (p * count + 99) / 100, seen = 0;
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+        seen += buckets[bucket];
+        if (seen >= rank && seen > 0) return 2L << bucket;
+    }
+    return 0;
+}
 
+static inline void print_latency_histogram(const char *label, const long *buckets) {
+    long count = 0;
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) count += buckets[bucket];
+    if (count == 0) return;
+    printf("%-15s %ld signals, p50 < %ld us, p95 < %ld us, p99 < %ld us, max < %ld us\n", label, count,
+           latency_percentile(buckets, count, 50), latency_percentile(buckets, count, 95),
+           latency_percentile(buckets, count, 99), latency_percentile(buckets, count, 100));
+}
 
 // Shared functions for both files
 void initialize_shared_resources();
 void cleanup_shared_resources();
-void sem_lock();
-void sem_unlock();
-void add_job_to_queue(pid_t pid, const char *job_name);
-command *get_next_job();
+void add_job_to_queue(int slot, pid_t pid);
+command *get_next_job(int cpu);
 void move_job_to_end(command *job);
 void remove_job_from_queue(command *job);
-int is_completed(pid_t pid);
 int NCPU;
 int TSLICE;
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE     // pipe2
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,18 +17,25 @@
 #include <wait.h>
 #include <errno.h>
 #include <sys/time.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
 
 #define SHM_NAME "my_shm"
 
 int scheduler_pid;      // Store Scheduler's PID
 int shm_fd_1;
 Shared_queue* shared_queue;
-int* number_of_jobs;
-int shm_fd_2;
+int job_capacity = MAX_JOBS;
+const char *policy_name = "rr"; // The scheduler's -P, named in the summary
+atomic_int jobs_in_flight = 0;  // Submitted by this shell and not yet reaped
 int status = 1;
+typedef struct history{
+    command job;
+    struct history* next;
+}history;
 typedef struct complete_queue{
-    command* head;
-    command* tail;
+    history* head;
+    history* tail;
 }complete_queue;
 complete_queue* Complete_queue;
 bool is_command_valid(char *input) {
@@ -51,46 +59,127 @@ void initialize_shared_resources() {
         perror("Shared memory creation failed");
         exit(1);
     }
-    if (ftruncate(shm_fd_1, 2046) == -1) {
+    if (ftruncate(shm_fd_1, shared_queue_size(job_capacity)) == -1) {
         perror("Shared memory resizing failed");
         exit(1);
     }
-    printf("sem opening\n");
-    shared_queue = (Shared_queue*) mmap(NULL, 2046, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd_1, 0);
-    if (shared_queue == MAP_FAILED) {
+    shared_queue = job_table_reserve();
+    if (shared_queue == NULL || job_table_map(shared_queue, shm_fd_1, job_capacity) == -1) {
         perror("Shared memory mapping failed");
         exit(1);
     }
-    shared_queue->head = NULL;
-    shared_queue->tail = NULL;
-    shm_fd_2 = shmget(IPC_PRIVATE, sizeof(int), IPC_CREAT | 0666);
-    if (shm_fd_2 < 0)
-    {
-        perror("Failed to create shared memory segment");
-        exit(EXIT_FAILURE);
+    // Left inheritable so the exec'ed scheduler can wait on it
+    int wakeup_fd = eventfd(0, 0);
+    if (wakeup_fd == -1) {
+        perror("Scheduler wakeup eventfd creation failed");
+        exit(1);
     }
-    number_of_jobs = (int *)shmat(shm_fd_2, NULL, 0);
-    if (number_of_jobs == (void *)-1)
-    {
-        perror("Failed to attach shared memory segment");
-        shmctl(shm_fd_2, IPC_RMID, NULL); // Cleanup if attachment failed
-        exit(EXIT_FAILURE);
-    }    
+    job_table_init(shared_queue, job_capacity, wakeup_fd);
 }
 
 // Cleanup shared resources
 void cleanup_shared_resources() {
-    munmap(shared_queue, 2046);
+    close(shared_queue->wakeup_fd);
+    munmap(shared_queue, shared_queue_size(ARENA_MAX_JOBS));
     close(shm_fd_1);
     shm_unlink(SHM_NAME);
-    shmctl(shm_fd_2, IPC_RMID, NULL);
 }
 
 
-// Parse the job name from input
-char* parse_job_name(char *input) {
-    strtok(input, " ");
-    return strtok(NULL, "\n");
+// One submit command or manifest line: [-n N] [-p PRIO] [-g CPUS] [est=MS] [deadline=MS] ./job [args...]
+typedef struct job_spec {
+    int copies;
+    int priority;
+    int width;                   // CPUs the job's processes run on together
+    int estimate_ms;             // CPU the job is expected to need, -1 when unknown
+    int deadline_ms;             // Time after submission it should finish by, 0 for none
+    int argc;
+    char *argv[MAX_JOB_ARGS + 1];
+} job_spec;
+
+bool parse_number(const char *token, int *value) {
+    char *end;
+    long number = strtol(token, &end, 10);
+    if (*token == '\0' || *end != '\0') return false;
+    *value = (int)number;
+    return true;
+}
+
+// est=MS and deadline=MS before the job name are hints for the srtf and edf
+// policies. Returns false if the token is not one.
+bool parse_hint(const char *token, job_spec *spec, bool *valid) {
+    int number = 0;
+    if (strncmp(token, "est=", 4) == 0) {
+        *valid = parse_number(token + 4, &number) && number >= 0;
+        spec->estimate_ms = number;
+    } else if (strncmp(token, "deadline=", 9) == 0) {
+        *valid = parse_number(token + 9, &number) && number >= 1;
+        spec->deadline_ms = number;
+    } else {
+        return false;
+    }
+    if (!*valid) printf("Invalid hint %s, expected a number of ms\n", token);
+    return true;
+}
+
+// Split a job description in place. Options and hints come first;
+// everything from the job name on is passed to the job as is, so only -p
+// sets the priority. Returns 0, or -1 with the problem printed.
+int parse_job_spec(char *input, job_spec *spec) {
+    spec->copies = 1;
+    spec->priority = DEFAULT_PRIORITY;
+    spec->width = 1;
+    spec->estimate_ms = -1;
+    spec->deadline_ms = 0;
+    spec->argc = 0;
+    char *saveptr;
+    char *token = strtok_r(input, " \t\n", &saveptr);
+
+    bool valid = true;
+    while (token != NULL && (token[0] == '-' || parse_hint(token, spec, &valid))) {
+        if (!valid) return -1;
+        if (token[0] != '-') {
+            token = strtok_r(NULL, " \t\n", &saveptr);
+            continue;
+        }
+        char *value = strtok_r(NULL, " \t\n", &saveptr);
+        int number;
+        if (value == NULL || !parse_number(value, &number)) {
+            printf("Option %s needs a number\n", token);
+            return -1;
+        }
+        if (strcmp(token, "-n") == 0 && number >= 1) {
+            spec->copies = number;
+        } else if (strcmp(token, "-p") == 0 && number >= 1 && number <= MLFQ_MAX_LEVELS) {
+            spec->priority = number;
+        } else if (strcmp(token, "-g") == 0 && number >= 1 && number <= NCPU) {
+            spec->width = number;
+        } else {
+            printf("Invalid option %s %s\n", token, value);
+            return -1;
+        }
+        token = strtok_r(NULL, " \t\n", &saveptr);
+    }
+    size_t spec_bytes = 0;
+    for (; token != NULL; token = strtok_r(NULL, " \t\n", &saveptr)) {
+        if (spec->argc == MAX_JOB_ARGS) {
+            printf("Too many arguments, at most %d\n", MAX_JOB_ARGS);
+            return -1;
+        }
+        // The launcher receives the arguments in one buffer of this size
+        spec_bytes += strlen(token) + 1;
+        if (spec_bytes > MAX_SPEC_BYTES) {
+            printf("Arguments too long, at most %d bytes\n", MAX_SPEC_BYTES);
+            return -1;
+        }
+        spec->argv[spec->argc++] = token;
+    }
+    spec->argv[spec->argc] = NULL;
+    if (spec->argc == 0) {
+        printf("Missing job name\n");
+        return -1;
+    }
+    return 0;
 }
 
 long get_current_time_ms() {
@@ -103,20 +192,17 @@ long get_current_time_ms() {
 
 
 
-void addToHistory(char* name, pid_t p_pid, int wait_time, int comp_time)
+void addToHistory(command *job)
 {
     // Allocate memory for the new job
-    command *new_job = (command *)malloc(sizeof(command));
+    history *new_job = (history *)malloc(sizeof(history));
     if (!new_job) {
         perror("Failed to allocate memory for new job");
         return;
     }
 
-    // Initialize the new job
-    new_job->pid = p_pid;
-    new_job->completion_time = comp_time;
-    new_job->wait_time = wait_time;
-    strcpy(*(new_job->name), name);
+    // Keep a private copy, the slot is reused once the job is freed
+    new_job->job = *job;
     new_job->next = NULL;
 
 
@@ -136,54 +222,35 @@ void Completed_jobs()
 {
     int status;
     pid_t pid;
+    struct rusage usage;
 
-    while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+    while ((pid = wait4(-1, &status, WNOHANG, &usage)) > 0)
     {
         if (WIFEXITED(status) || WIFSIGNALED(status)){        
-            command *prev = NULL;
-            command *current = shared_queue->head;
-
-            // Traverse the queue to find the job with the matching PID
-            while (current != NULL)
+            // The run queue belongs to the scheduler, look the PID up in the index
+            int slot = pid_index_lookup(shared_queue, pid);
+            if (slot != NO_JOB)
             {
-                if (current->pid == pid)
-                {
-                    current->end_time = get_current_time_ms();
-                    current->completion_time = current->end_time - current->start_time;
-                    if (current->completion_time % TSLICE != 0) {
-                        current->completion_time = ((current->completion_time / TSLICE) + 1) * TSLICE;
-                    }                    
-                    current->wait_time = current->completion_time - current->burst_time;
-
-                    // Add the job to history
-                    addToHistory(*(current->name), current->pid, current->wait_time, current->completion_time);
-                    
-                    // Update current job count
-                    (*number_of_jobs)--;
-
-                    // Remove the job node from the linked list
-                    if (prev == NULL)
-                    {
-                        // Removing the head node
-                        shared_queue->head = current->next;
-                    }
-                    else
-                    {
-                        // Removing a middle or tail node
-                        prev->next = current->next;
-                    }
-
-                    // Update tail if we removed the last node
-                    if (current == shared_queue->tail)
-                    {
-                        shared_queue->tail = prev;
-                    }
-
-                    free(current);
-                    break;
-                }
-                prev = current;
-                current = current->next;
+                command finished = *job_at(shared_queue, slot);
+                finished.end_time = get_current_time_ms();
+                finished.completion_time = finished.end_time - finished.start_time;
+                // The kernel's rusage is exact, unlike counting slices
+                finished.cpu_time = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000 +
+                                    (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+                finished.context_switches = usage.ru_nvcsw + usage.ru_nivcsw;
+                finished.wait_time = finished.completion_time - finished.cpu_time;
+                if (finished.wait_time < 0) finished.wait_time = 0;
+                finished.response_time = finished.first_run_time > 0 ?
+                    finished.first_run_time - finished.start_time : finished.completion_time;
+                finished.status = COMPLETED;
+
+                // Add the job to history
+                addToHistory(&finished);
+                
+                // Let the scheduler unlink the job and free its slot
+                pid_index_remove(shared_queue, pid);
+                event_ring_post(shared_queue, JOB_COMPLETED, slot);
+                atomic_fetch_sub(&jobs_in_flight, 1);
             }
         }
     }    
@@ -197,6 +264,102 @@ void handle_SIGCHLD(int signum)
 
 
 
+int compare_ints(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of a sorted array
+int percentile(int *sorted, int count, int p) {
+    int rank = (p * count + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+void print_percentiles(const char *label, int *values, int count) {
+    qsort(values, count, sizeof(int), compare_ints);
+    printf("%-12s %8d %8d %8d %8d\n", label, percentile(values, count, 50),
+           percentile(values, count, 95), percentile(values, count, 99), values[count - 1]);
+}
+
+// p50/p95/p99 of the per-job times across the whole history, in ms
+void print_latency_summary()
+{
+    int count = 0;
+    for (history *temp = Complete_queue->head; temp != NULL; temp = temp->next) count++;
+
+    int *response = malloc(sizeof(int) * count);
+    int *turnaround = malloc(sizeof(int) * count);
+    int *wait = malloc(sizeof(int) * count);
+    int *cpu = malloc(sizeof(int) * count);
+    if (!response || !turnaround || !wait || !cpu) {
+        perror("Failed to allocate memory for the summary");
+        free(response); free(turnaround); free(wait); free(cpu);
+        return;
+    }
+    int i = 0;
+    for (history *temp = Complete_queue->head; temp != NULL; temp = temp->next, i++) {
+        response[i] = temp->job.response_time;
+        turnaround[i] = temp->job.completion_time;
+        wait[i] = temp->job.wait_time;
+        cpu[i] = temp->job.cpu_time;
+    }
+
+    printf("\n-------- Summary over %d jobs (ms) --------\n", count);
+    printf("%-12s %8s %8s %8s %8s\n", "", "p50", "p95", "p99", "max");
+    print_percentiles("Response", response, count);
+    print_percentiles("Turnaround", turnaround, count);
+    print_percentiles("Wait", wait, count);
+    print_percentiles("CPU", cpu, count);
+    free(response); free(turnaround); free(wait); free(cpu);
+
+    // Slowdown is turnaround over CPU time, see bounded_slowdown()
+    double slowdown = 0;
+    int deadlines = 0, missed = 0;
+    for (history *temp = Complete_queue->head; temp != NULL; temp = temp->next) {
+        slowdown += bounded_slowdown(temp->job.completion_time, temp->job.cpu_time);
+        if (temp->job.deadline > 0) {
+            deadlines++;
+            if (temp->job.end_time > temp->job.deadline) missed++;
+        }
+    }
+    printf("Slowdown     %8.2f mean under %s\n", slowdown / count, policy_name);
+    if (deadlines > 0) printf("Deadlines    %8d of %d missed\n", missed, deadlines);
+}
+
+// Read the scheduler's statistics page; the seqlock never blocks the scheduler
+void print_stats()
+{
+    sched_stats stats;
+    stats_read(shared_queue, &stats);
+    if (stats.started_ms == 0) {
+        printf("The scheduler has not published statistics yet\n");
+        return;
+    }
+    double uptime_s = (get_current_time_ms() - stats.started_ms) / 1000.0;
+    printf("\n-------- Scheduler statistics --------\n");
+    printf("Uptime          %.3f s\n", uptime_s);
+    printf("Queue depth     %d ready, %d running\n", stats.ready_jobs, stats.running_jobs);
+    for (int cpu = 0; cpu < stats.n_cpus; cpu++) {
+        if (stats.cpu_pid[cpu] > 0) {
+            printf("CPU %-3d         pid %d\n", cpu, stats.cpu_pid[cpu]);
+        } else {
+            printf("CPU %-3d         idle\n", cpu);
+        }
+    }
+    printf("Slices          %ld\n", stats.slices);
+    printf("Signals         %ld SIGSTOP, %ld SIGCONT\n", stats.sigstops, stats.sigconts);
+    printf("Loop overhead   %.3f%% over %ld wakeups, %.1f us each\n",
+           uptime_s > 0 ? stats.loop_ns / 1e7 / uptime_s : 0, stats.wakeups,
+           stats.wakeups > 0 ? stats.loop_ns / 1e3 / stats.wakeups : 0);
+    printf("Completed       %ld jobs, %.2f jobs/s\n", stats.completed,
+           uptime_s > 0 ? stats.completed / uptime_s : 0);
+    // Only filled in when the scheduler runs with -l
+    print_latency_histogram("Switch-in", stats.switch_in);
+    print_latency_histogram("Switch-out", stats.switch_out);
+    if (stats.probe_timeouts > 0) printf("Unconfirmed     %ld signals\n", stats.probe_timeouts);
+    print_quantum_history(&stats);
+}
+
 void print_job_info()
 {
     printf("\n-------- Command History --------\n");
@@ -206,20 +369,30 @@ void print_job_info()
     }
     else
     {
-        command* temp = Complete_queue->head;
+        history* temp = Complete_queue->head;
         while(temp!=NULL)
         {
-            printf("Command: %s\n", *(temp->name));
-            printf("PID: %d\n", temp->pid);
-            printf("Wait time : %d\n", temp->wait_time);
-            printf("Execution time : %d\n", temp->completion_time);
-            printf("Status : %d\n ",temp->status);
+            printf("Command: %s\n", temp->job.name);
+            printf("PID: %d\n", temp->job.pid);
+            printf("Response time : %d\n", temp->job.response_time);
+            printf("Wait time : %d\n", temp->job.wait_time);
+            printf("CPU time : %d\n", temp->job.cpu_time);
+            printf("Execution time : %d\n", temp->job.completion_time);
+            printf("Context switches : %ld\n", temp->job.context_switches);
+            if (temp->job.deadline > 0) {
+                long late = temp->job.end_time - temp->job.deadline;
+                printf("Deadline : %s by %ld ms\n", late > 0 ? "missed" : "met", late > 0 ? late : -late);
+            }
+            printf("Status : %d\n ",temp->job.status);
 
 
             printf("-----------------------------\n");
             usleep(80);
+            temp = temp->next;
         }
+        print_latency_summary();
     }
+    print_stats();
 }
 
 
@@ -227,69 +400,375 @@ void print_job_info()
 
 
 
-// Add job to the queue
-void add_job_to_queue(int pid, const char *job_name) {
-    // Allocate memory for the new job
-    command *new_job = (command *)malloc(sizeof(command));
-    if (!new_job) {
-        perror("Failed to allocate memory for new job");
-        return;
+// Add job to the queue; the caller blocks SIGCHLD around the post
+void add_job_to_queue(int slot, pid_t pid) {
+    command *new_job = job_at(shared_queue, slot);
+    new_job->pid = pid;
+    atomic_fetch_add(&jobs_in_flight, 1);
+    event_ring_post(shared_queue, JOB_SUBMITTED, slot);
+}
+
+// Hand a chain of slots linked through next to the scheduler as one event,
+// so it admits the whole batch before it dispatches any of it; SIGCHLD is
+// blocked by the caller, as for add_job_to_queue()
+void add_batch_to_queue(int first, int count) {
+    atomic_fetch_add(&jobs_in_flight, count);
+    event_ring_post(shared_queue, JOB_BATCH_SUBMITTED, first);
+}
+
+// Rebuild the pid index after the slots of a larger table, once the shared
+// object covers it, and switch the table to the new capacity; the caller
+// keeps the SIGCHLD handler from removing entries meanwhile
+void resize_pid_index(int capacity) {
+    int old_cells = shared_queue->pid_index_size;
+    int cells = pid_index_cells(capacity);
+    atomic_int *index = pid_index(shared_queue);
+    int *live = malloc(sizeof(int) * old_cells);
+    if (live == NULL) {
+        perror("Failed to allocate memory for the pid index");
+        exit(1);
+    }
+    int count = 0;
+    for (int cell = 0; cell < old_cells; cell++) {
+        int slot = atomic_load(&index[cell]);
+        if (slot != NO_JOB) live[count++] = slot;
+    }
+    shared_queue->capacity = capacity;
+    index = pid_index(shared_queue);
+    for (int cell = 0; cell < cells; cell++) {
+        atomic_store(&index[cell], NO_JOB);
+    }
+    shared_queue->pid_index_size = cells;
+    for (int i = 0; i < count; i++) {
+        pid_index_add(shared_queue, live[i]);
+    }
+    free(live);
+}
+
+// Double the table in place: extend the shared object, map the new slots at
+// the same address and only then tell the scheduler, through the generation,
+// and hand them out. Returns false once ARENA_MAX_JOBS is reached.
+bool grow_job_table() {
+    int old_capacity = shared_queue->capacity;
+    if (old_capacity >= ARENA_MAX_JOBS) return false;
+    int capacity = old_capacity < ARENA_MAX_JOBS / 2 ? old_capacity * 2 : ARENA_MAX_JOBS;
+    if (ftruncate(shm_fd_1, shared_queue_size(capacity)) == -1 ||
+        job_table_map(shared_queue, shm_fd_1, capacity) == -1) {
+        perror("Job table growth failed");
+        return false;
+    }
+
+    sigset_t sigchld, saved;
+    sigemptyset(&sigchld);
+    sigaddset(&sigchld, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &sigchld, &saved);
+    resize_pid_index(capacity);
+    sigprocmask(SIG_SETMASK, &saved, NULL);
+
+    atomic_fetch_add_explicit(&shared_queue->generation, 1, memory_order_release);
+    job_table_add_slots(shared_queue, old_capacity, capacity);
+    return true;
+}
+
+// Fill in a free slot for a job that is about to be forked
+int reserve_job_slot(const char *job_name, job_spec *spec) {
+    int slot;
+    while ((slot = job_alloc(shared_queue)) == NO_JOB) {
+        if (!grow_job_table()) return NO_JOB;
     }
 
     // Initialize the new job
-    new_job->pid = pid;
+    command *new_job = job_at(shared_queue, slot);
+    new_job->pid = 0;
     new_job->status = READY;
     new_job->completion_time = 0;
     new_job->wait_time = 0;
     new_job->burst_time = 0;
-    strcpy(*(new_job->name), job_name);
-    signal(SIGINT, SIG_IGN); 
+    new_job->remaining_time = spec->estimate_ms >= 0 ? spec->estimate_ms * 1000L : -1;
+    new_job->priority = spec->priority;
+    new_job->width = spec->width;
+    new_job->level = 0;
+    new_job->quantum_used = 0;
+    new_job->vruntime = 0;
+    new_job->heap_index = -1;
+    new_job->cpu = 0;
+    snprintf(new_job->name, sizeof(new_job->name), "%s", job_name);
+    new_job->response_time = 0;
+    new_job->cpu_time = 0;
+    new_job->context_switches = 0;
+    new_job->first_run_time = 0;
     new_job->start_time = get_current_time_ms();
-    new_job->next = NULL;
+    new_job->deadline = spec->deadline_ms > 0 ? new_job->start_time + spec->deadline_ms : 0;
+    new_job->end_time = 0;
+    return slot;
+}
+
+// A launcher is a child forked ahead of time and parked in SIGSTOP. When the
+// scheduler resumes it for its first slice it reads the job spec from its
+// pipe and execs the job, keeping its pid, so submitting never waits for a
+// fork.
+typedef struct launcher {
+    pid_t pid;
+    int spec_fd;                 // Write end of the launcher's spec pipe
+} launcher;
+
+launcher *launcher_pool;
+int pool_size = DEFAULT_POOL_SIZE;
+int pool_count = 0;
+
+void run_launcher(int spec_fd) {
+    signal(SIGINT, SIG_IGN);
+    // Lead a process group of its own so the scheduler's killpg reaches
+    // whatever the job forks; the shell sets it too, so neither side races
+    setpgid(0, 0);
+    kill(getpid(), SIGSTOP);
+
+    // The spec is its length followed by the NUL-terminated arguments
+    char spec[MAX_SPEC_BYTES];
+    int len;
+    if (read(spec_fd, &len, sizeof(len)) != sizeof(len) || len <= 0 || len > (int)sizeof(spec) ||
+        read(spec_fd, spec, len) != len || spec[len - 1] != '\0') {
+        _exit(1);
+    }
+    char *args[MAX_JOB_ARGS + 1];
+    int argc = 0;
+    for (int i = 0; i < len && argc < MAX_JOB_ARGS; i += strlen(spec + i) + 1) {
+        args[argc++] = spec + i;
+    }
+    args[argc] = NULL;
+    if (execvp(args[0], args) == -1)
+    {
+        printf("%s : command not found\n", args[0]);
+        exit(1);
+    }
+    printf("DOESNT EXECUTE\n");
+}
 
+// Fork a launcher and wait until it is parked, so the scheduler's SIGCONT can
+// never arrive before the launcher's own SIGSTOP
+launcher spawn_launcher() {
+    launcher new_launcher = { -1, -1 };
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) == -1) {
+        perror("Launcher pipe creation failed");
+        return new_launcher;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("failed fork");
+        close(fds[0]);
+        close(fds[1]);
+        return new_launcher;
+    }
+    if (pid == 0) {
+        close(fds[1]);
+        run_launcher(fds[0]);
+    }
+    close(fds[0]);
+    setpgid(pid, pid);
+    int wstatus;
+    while (waitpid(pid, &wstatus, WUNTRACED) == -1 && errno == EINTR);
+    new_launcher.pid = pid;
+    new_launcher.spec_fd = fds[1];
+    return new_launcher;
+}
 
-    if (shared_queue->head == NULL) {
-        // Queue is empty, initialize head and tail
-        shared_queue->head = new_job;
-        shared_queue->tail = new_job;
-    } else {
-        // Add to the end of the queue
-        shared_queue->tail->next = new_job;
-        shared_queue->tail = new_job;
+// Top the pool up once it is half empty, between commands rather than on a
+// submission's critical path
+void refill_launcher_pool() {
+    if (pool_count > pool_size / 2) return;
+    while (pool_count < pool_size) {
+        launcher new_launcher = spawn_launcher();
+        if (new_launcher.pid == -1) break;
+        launcher_pool[pool_count++] = new_launcher;
+    }
+}
+
+// A parked launcher from the pool, or a freshly forked one if it ran dry
+launcher take_launcher() {
+    if (pool_count > 0) {
+        return launcher_pool[--pool_count];
+    }
+    return spawn_launcher();
+}
+
+void drain_launcher_pool() {
+    while (pool_count > 0) {
+        launcher idle = launcher_pool[--pool_count];
+        close(idle.spec_fd);
+        kill(idle.pid, SIGKILL);
+    }
+}
+
+// Give a reserved slot a launcher and send it the job's arguments, which
+// parse_job_spec() has checked to fit. Returns false if that failed.
+bool launch_job(int slot, job_spec *spec) {
+    char buffer[sizeof(int) + MAX_SPEC_BYTES];
+    int len = 0;
+    for (int i = 0; i < spec->argc; i++) {
+        int arg_len = strlen(spec->argv[i]) + 1;
+        memcpy(buffer + sizeof(int) + len, spec->argv[i], arg_len);
+        len += arg_len;
+    }
+    memcpy(buffer, &len, sizeof(len));
+
+    launcher job_launcher = take_launcher();
+    if (job_launcher.pid == -1) {
+        return false;
+    }
+    // A single write below the pipe's capacity, waiting in the pipe by the
+    // time the scheduler wakes the launcher
+    if (write(job_launcher.spec_fd, buffer, sizeof(int) + len) != (ssize_t)(sizeof(int) + len)) {
+        perror("Failed to hand the job to its launcher");
+        close(job_launcher.spec_fd);
+        kill(job_launcher.pid, SIGKILL);
+        return false;
+    }
+    close(job_launcher.spec_fd);
+    job_at(shared_queue, slot)->pid = job_launcher.pid;
+    pid_index_add(shared_queue, slot);
+    return true;
+}
+
+// The command line shown in the history
+void describe_job(job_spec *spec, char *name, size_t size) {
+    size_t used = 0;
+    name[0] = '\0';
+    for (int i = 0; i < spec->argc && used < size; i++) {
+        used += snprintf(name + used, size - used, i ? " %s" : "%s", spec->argv[i]);
+    }
+}
+
+// Submit every copy of every spec. A single job is posted as before; more
+// are reserved up front and posted as one batch, or not at all if the
+// table cannot hold them.
+void submit_jobs(job_spec *specs, int count) {
+    int total = 0;
+    for (int i = 0; i < count; i++) total += specs[i].copies;
+
+    int first = NO_JOB, last = NO_JOB, reserved = 0;
+    char name[256];
+    for (int i = 0; i < count; i++) {
+        describe_job(&specs[i], name, sizeof(name));
+        for (int copy = 0; copy < specs[i].copies; copy++) {
+            int slot = reserve_job_slot(name, &specs[i]);
+            if (slot == NO_JOB) {
+                printf("Job table is full (%d jobs), %d of %d jobs did not fit\n",
+                       shared_queue->capacity, total - reserved, total);
+                while (first != NO_JOB) {
+                    int next = job_at(shared_queue, first)->next;
+                    job_free(shared_queue, first);
+                    first = next;
+                }
+                return;
+            }
+            job_at(shared_queue, slot)->next = NO_JOB;
+            if (last == NO_JOB) {
+                first = slot;
+            } else {
+                job_at(shared_queue, last)->next = slot;
+            }
+            last = slot;
+            reserved++;
+        }
     }
 
+    // The SIGCHLD handler removes reaped jobs from the pid index, keep it
+    // from running in the middle of an insertion
+    sigset_t sigchld, saved;
+    sigemptyset(&sigchld);
+    sigaddset(&sigchld, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &sigchld, &saved);
+    int slot = first, launched = 0, last_launched = NO_JOB;
+    bool failed = false;
+    for (int i = 0; i < count && !failed; i++) {
+        for (int copy = 0; copy < specs[i].copies; copy++) {
+            if (!launch_job(slot, &specs[i])) {
+                failed = true;
+                break;
+            }
+            last_launched = slot;
+            slot = job_at(shared_queue, slot)->next;
+            launched++;
+        }
+    }
+    if (failed) {
+        // The jobs that got a launcher still go to the scheduler, which
+        // resumes them; the rest give their slots back
+        printf("Could not start a launcher, %d of %d jobs were not submitted\n", total - launched, total);
+        if (last_launched != NO_JOB) job_at(shared_queue, last_launched)->next = NO_JOB;
+        while (slot != NO_JOB) {
+            int next = job_at(shared_queue, slot)->next;
+            job_free(shared_queue, slot);
+            slot = next;
+        }
+    }
+    // Still with SIGCHLD blocked: a completion posted by the handler while
+    // this post holds an unpublished ring cell would spin on a full ring
+    if (launched == 1) {
+        add_job_to_queue(first, job_at(shared_queue, first)->pid);
+    } else if (launched > 1) {
+        add_batch_to_queue(first, launched);
+    }
+    sigprocmask(SIG_SETMASK, &saved, NULL);
+    signal(SIGCHLD, handle_SIGCHLD);
 }
 
 // Submit a job to the scheduler
-void submit_job(char *job_name) {
-    char** args = malloc(2046);
-    args[0] = job_name;
-    args[1] = NULL;
-    // Execute the command
-    pid_t p_pid = fork();
-    if (p_pid < 0)
-    {
-        printf("failed fork");
-        exit(1);
+void submit_job(char *input) {
+    job_spec spec;
+    if (parse_job_spec(input, &spec) == 0) {
+        submit_jobs(&spec, 1);
+    } else {
+        printf("Invalid submit command. Use: submit [-n copies] [-p priority 1-%d] [-g cpus] [est=ms] [deadline=ms] ./job_name [args...]\n"
+               "Options and hints go before the job name; everything after it is passed to the job unchanged.\n", MLFQ_MAX_LEVELS);
     }
-    if (p_pid == 0)
-    {
-        add_job_to_queue(p_pid, job_name);
-        (*number_of_jobs)++;
-        kill(getpid(), SIGSTOP);
+}
 
-        if (execvp(args[0], args) == -1)
-        {
-            printf("%s : command not found\n", args[0]);
-            exit(1);
+// Submit every job of a manifest, one per line in the submit syntax, as one
+// batch; blank lines and lines starting with # are skipped
+void submit_batch_file(char *path) {
+    FILE *manifest = fopen(path, "r");
+    if (manifest == NULL) {
+        perror(path);
+        return;
+    }
+    int count = 0, allocated = 0;
+    job_spec *specs = NULL;
+    char **lines = NULL;
+    char *line = NULL;
+    size_t len = 0;
+    int line_number = 0;
+    bool ok = true;
+    while (ok && getline(&line, &len, manifest) != -1) {
+        line_number++;
+        char *start = line + strspn(line, " \t");
+        if (*start == '\n' || *start == '\0' || *start == '#') continue;
+        if (count == allocated) {
+            allocated = allocated ? allocated * 2 : 64;
+            specs = realloc(specs, sizeof(job_spec) * allocated);
+            lines = realloc(lines, sizeof(char *) * allocated);
+            if (specs == NULL || lines == NULL) {
+                perror("Failed to allocate memory for the batch");
+                exit(1);
+            }
+        }
+        lines[count] = strdup(start);  // The spec points into its own copy
+        if (parse_job_spec(lines[count], &specs[count]) == -1) {
+            printf("%s:%d: invalid job\n", path, line_number);
+            ok = false;
         }
-        printf("DOESNT EXECUTE\n");
+        count++;
     }
-    else
-    {
-        signal(SIGCHLD, handle_SIGCHLD);
+    free(line);
+    fclose(manifest);
 
-    }    
+    if (ok && count > 0) {
+        submit_jobs(specs, count);
+    }
+    for (int i = 0; i < count; i++) free(lines[i]);
+    free(lines);
+    free(specs);
 }
 
 void handle_SIGINT(int signum)
@@ -299,7 +778,7 @@ void handle_SIGINT(int signum)
     while (status == 0)
     {
         int check = 1;
-        if(shared_queue->head==NULL && shared_queue->tail==NULL){
+        if(atomic_load(&jobs_in_flight) == 0){
             check = 0;
         }
 
@@ -307,6 +786,7 @@ void handle_SIGINT(int signum)
         if (!check)
         {
             print_job_info();
+            drain_launcher_pool();
             kill(scheduler_pid, SIGTERM); // Send termination signal
             printf("Scheduler process terminated.\n");
             cleanup_shared_resources();
@@ -327,20 +807,24 @@ void shell_loop() {
 
 
     while (status) {
+        refill_launcher_pool();
         printf("SimpleShell$ ");
         if (getline(&command, &len, stdin) == -1) {
             perror("Input error");
-            free(command);
             break;
         }
         if (is_command_valid(command)) {
-            if (strncmp(command, "submit", 6) == 0) {
-                char *job_name = parse_job_name(command);
-                if (job_name) {
-                    submit_job(job_name);
+            if (strncmp(command, "submit-batch", 12) == 0) {
+                char *path = strtok(command + 12, " \t\n");
+                if (path) {
+                    submit_batch_file(path);
                 } else {
-                    printf("Invalid submit command. Use: submit ./job_name\n");
+                    printf("Invalid submit-batch command. Use: submit-batch <manifest>\n");
                 }
+            } else if (strncmp(command, "submit", 6) == 0) {
+                submit_job(command + 6);
+            } else if (strncmp(command, "stats", 5) == 0) {
+                print_stats();
             } /*else if (strncmp(command, "history", 7) == 0) {
                 display_command_history();
             } */else if (strncmp(command, "exit", 4) == 0) {
@@ -354,16 +838,25 @@ void shell_loop() {
 }
 
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        fprintf(stderr, "Usage: %s <NCPU> <TSLICE>\n", argv[0]);
+    sched_options options;
+    if (parse_sched_options(argc, argv, &options) == -1 || options.bench_jobs > 0 || options.trace_path != NULL ||
+        (argc - optind != 2 && argc - optind != 3)) {
+        fprintf(stderr, "Usage: %s [-P rr|mlfq|cfs|srtf|edf] [-L levels] [-B boost_ms] [-A min:max] [-l] [-z launchers] <NCPU> <TSLICE> [MAX_JOBS]\n", argv[0]);
         exit(1);
     }
-    NCPU = atoi(argv[1]);
-    TSLICE = atoi(argv[2]);
+    NCPU = atoi(argv[optind]);
+    TSLICE = atoi(argv[optind + 1]);
     if(NCPU<=0 || TSLICE<=0){
         printf("Number of CPU's and time quantum should be positive integers.");
         exit(0);
     }
+    if (argc - optind == 3) {
+        job_capacity = atoi(argv[optind + 2]);
+        if (job_capacity <= 0 || job_capacity > ARENA_MAX_JOBS) {
+            printf("Initial job table capacity should be between 1 and %d.", ARENA_MAX_JOBS);
+            exit(0);
+        }
+    }
     Complete_queue = (complete_queue*)malloc(sizeof(complete_queue)*256);
     Complete_queue->head = NULL;
     Complete_queue->tail = NULL;
@@ -373,10 +866,22 @@ int main(int argc, char *argv[]) {
     scheduler_pid = fork();
     setpgid(0,0);
     if (scheduler_pid == 0) {
-        execl("./SimpleScheduler", "./SimpleScheduler", argv[1], argv[2], NULL);
+        // The scheduler takes the same arguments and reads the capacity from the table
+        argv[0] = "./SimpleScheduler";
+        execv("./SimpleScheduler", argv);
         perror("Scheduler execution failed");
         exit(1);
     }
+    // Jobs have no use for the scheduler's wakeup fd
+    fcntl(shared_queue->wakeup_fd, F_SETFD, FD_CLOEXEC);
+
+    pool_size = options.pool_size;
+    policy_name = options.policy;
+    launcher_pool = malloc(sizeof(launcher) * (pool_size > 0 ? pool_size : 1));
+    if (launcher_pool == NULL) {
+        perror("Failed to allocate the launcher pool");
+        exit(1);
+    }
 
     shell_loop();  // Start the shell loop
     return 0;
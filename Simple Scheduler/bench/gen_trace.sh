@@ -0,0 +1,27 @@
+#!/bin/bash
+# Writes a simulator trace: Poisson arrivals and exponential bursts, with a
+# few long CPU hogs mixed in. With SLACK, every job also gets an estimate
+# within 30% of its burst and a deadline SLACK times its burst plus 10 ms
+# after its arrival, for the srtf and edf policies.
+# Usage: ./gen_trace.sh JOBS MEAN_GAP_MS MEAN_BURST_MS [SEED] [SLACK] > trace.txt
+# Replay it with: ./SimpleScheduler -P <policy> -s trace.txt NCPU TSLICE [MAX_JOBS]
+
+if [ $# -lt 3 ]; then
+    echo "Usage: $0 JOBS MEAN_GAP_MS MEAN_BURST_MS [SEED] [SLACK]" >&2
+    exit 1
+fi
+
+awk -v jobs="$1" -v gap="$2" -v burst="$3" -v seed="${4:-1}" -v slack="${5:-0}" 'BEGIN {
+    srand(seed)
+    print "# arrival_ms burst_ms priority" (slack > 0 ? " est=ms deadline=ms" : "")
+    t = 0
+    for (i = 0; i < jobs; i++) {
+        t += -gap * log(1 - rand())
+        b = -burst * log(1 - rand())
+        if (rand() < 0.05) b *= 20     # CPU hog
+        if (b < 0.001) b = 0.001
+        printf "%.3f %.3f %d", t, b, 1 + int(rand() * 4)
+        if (slack > 0) printf " est=%.1f deadline=%.1f", b * (0.7 + 0.6 * rand()), b * slack + 10
+        printf "\n"
+    }
+}'
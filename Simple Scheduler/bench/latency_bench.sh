@@ -0,0 +1,41 @@
+#!/bin/bash
+# Measures how long signals take to take effect: SIGCONT until the job is
+# really on a core (switch-in) and SIGSTOP until it is stopped (switch-out).
+# For every NCPU and TSLICE it runs the shell with -l, submits JOBS copies of
+# latency_job, waits for them and prints the scheduler's latency histograms.
+# Usage: bench/latency_bench.sh [NCPUS] [TSLICES] [JOBS_PER_CPU] [RUN_MS]
+# e.g.:  bench/latency_bench.sh "1 2 4" "5 10 20" 3 300
+# Run it from the directory holding SimpleShell and SimpleScheduler. Each
+# run takes at least 10 s, the time the shell waits before its summary.
+
+ncpus=${1:-"1 2 4"}
+tslices=${2:-"5 10 20"}
+per_cpu=${3:-3}
+run_ms=${4:-300}
+
+if [ ! -x ./SimpleShell ] || [ ! -x ./SimpleScheduler ]; then
+    echo "Build SimpleShell and SimpleScheduler here first" >&2
+    exit 1
+fi
+gcc -O2 -o bench/latency_job bench/latency_job.c || exit 1
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+log=$work/log
+# The script keeps the shell's input open; end of input would make it exit
+mkfifo "$work/input"
+
+for ncpu in $ncpus; do
+    for tslice in $tslices; do
+        jobs=$((ncpu * per_cpu))
+        ./SimpleShell -l "$ncpu" "$tslice" < "$work/input" > "$log" 2>&1 &
+        shell=$!
+        exec 3> "$work/input"
+        printf "submit -n %d ./bench/latency_job %d\n" "$jobs" "$run_ms" >&3
+        sleep 1
+        kill -INT "$shell"
+        wait "$shell"
+        exec 3>&-
+        echo "NCPU $ncpu TSLICE $tslice ms, $jobs jobs of $run_ms ms"
+        grep -E "^(Switch-in|Switch-out|Unconfirmed)" "$log" | sed 's/^/  /'
+    done
+done
@@ -0,0 +1,17 @@
+// CPU-bound job for latency_bench.sh: spins until it has used argv[1] ms of
+// CPU (300 by default), so it is stopped and resumed at every slice boundary
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../dummy_main.h"
+
+int main(int argc, char **argv) {
+    long run_ms = argc > 1 ? atol(argv[1]) : 300;
+    volatile unsigned long spins = 0;
+    struct timespec used;
+    do {
+        for (int i = 0; i < 100000; i++) spins++;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &used);
+    } while (used.tv_sec * 1000L + used.tv_nsec / 1000000 < run_ms);
+    return 0;
+}
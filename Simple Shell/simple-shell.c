@@ -1,9 +1,18 @@
+#define _GNU_SOURCE     //pipe2, posix_spawn_file_actions_addclose
 #include<stdio.h>
 #include<unistd.h>
 #include<string.h>
 #include<sys/wait.h>
 #include<sys/time.h>
+#include<time.h>
+#include<signal.h>
 #include<stdlib.h>
+#include<errno.h>
+#include<fcntl.h>
+#include<sys/stat.h>
+#include<spawn.h>
+
+extern char **environ;
 
 void shell_loop();
 char **parse_for_piping(char* input, int* n);
@@ -128,6 +137,322 @@ void check_bgProcess() {
         }
     }
 }
+//cache of resolved command paths, like bash's hash: PATH is searched once
+//in the shell instead of by execvp in every forked child
+#define HASH_BUCKETS 64
+
+typedef struct hashed_path {
+    char *name;
+    char *path;
+    int hits;
+    struct hashed_path *next;
+} hashed_path;
+
+hashed_path *path_table[HASH_BUCKETS];
+char *hashed_for_path = NULL;   //PATH the cached entries were resolved against
+
+unsigned int hash_name(const char *name){
+    unsigned int h = 5381;
+    while(*name){
+        h = h * 33 + (unsigned char)*name++;
+    }
+    return h % HASH_BUCKETS;
+}
+
+void clear_path_table(){
+    for(int i = 0; i < HASH_BUCKETS; i++){
+        hashed_path *curr = path_table[i];
+        while(curr != NULL){
+            hashed_path *next = curr->next;
+            free(curr->name);
+            free(curr->path);
+            free(curr);
+            curr = next;
+        }
+        path_table[i] = NULL;
+    }
+}
+
+//drop one entry, e.g. when its file is gone
+void forget_path(const char *name){
+    hashed_path **link = &path_table[hash_name(name)];
+    while(*link != NULL){
+        if(strcmp((*link)->name, name) == 0){
+            hashed_path *gone = *link;
+            *link = gone->next;
+            free(gone->name);
+            free(gone->path);
+            free(gone);
+            return;
+        }
+        link = &(*link)->next;
+    }
+}
+
+//search PATH the way execvp does, an empty entry meaning the current directory
+char *search_path(const char *name){
+    const char *dirs = getenv("PATH");
+    if(dirs == NULL) dirs = "/bin:/usr/bin";
+    char candidate[4096];
+    struct stat st;
+    while(1){
+        const char *end = strchr(dirs, ':');
+        int len = end ? end - dirs : (int)strlen(dirs);
+        snprintf(candidate, sizeof(candidate), "%.*s%s%s", len, dirs, len ? "/" : "./", name);
+        if(stat(candidate, &st) == 0 && S_ISREG(st.st_mode) && access(candidate, X_OK) == 0){
+            return strdup(candidate);
+        }
+        if(end == NULL) return NULL;
+        dirs = end + 1;
+    }
+}
+
+//path to exec for a command, NULL if it is not found; names with a slash
+//are used as they are. hit counts the lookup as a launch
+const char *lookup_path(const char *name, int hit){
+    if(name == NULL) return NULL;
+    if(strchr(name, '/') != NULL) return name;
+
+    const char *dirs = getenv("PATH");
+    if(dirs == NULL) dirs = "";
+    if(hashed_for_path == NULL || strcmp(hashed_for_path, dirs) != 0){
+        clear_path_table();
+        free(hashed_for_path);
+        hashed_for_path = strdup(dirs);
+    }
+
+    unsigned int bucket = hash_name(name);
+    for(hashed_path *curr = path_table[bucket]; curr != NULL; curr = curr->next){
+        if(strcmp(curr->name, name) == 0){
+            curr->hits += hit;
+            return curr->path;
+        }
+    }
+    char *path = search_path(name);
+    if(path == NULL) return NULL;
+    hashed_path *entry = malloc(sizeof(hashed_path));
+    entry->name = strdup(name);
+    entry->path = path;
+    entry->hits = hit;
+    entry->next = path_table[bucket];
+    path_table[bucket] = entry;
+    return entry->path;
+}
+
+//in the child: exec the resolved path, or tell the parent why it failed
+//through the close-on-exec pipe
+void exec_resolved(char **args, const char *path, int err_fd){
+    int err = ENOENT;
+    if(path != NULL){
+        execv(path, args);
+        err = errno;
+    }
+    if(write(err_fd, &err, sizeof(err)) == -1){
+        //the parent is gone, nothing left to tell
+    }
+    printf("Invalid Prompt\n");
+    exit(1);
+}
+
+//in the parent: an exec that failed with ENOENT means the cached file is gone
+void check_exec(char **args, int err_fd){
+    int err;
+    if(read(err_fd, &err, sizeof(err)) == sizeof(err) && err == ENOENT && args[0] != NULL){
+        forget_path(args[0]);
+    }
+    close(err_fd);
+}
+
+//launch with posix_spawn by default: the child shares the shell's memory
+//until it execs, so nothing is copied however large the shell has grown.
+//"launch fork" switches back to fork, which copies the page tables
+int use_spawn = 1;
+
+//start a command with its stdin and stdout moved to in_fd and out_fd unless
+//they are -1, and close_fd closed in the child. returns the pid, or -1 if
+//the command could not be started
+int start_process(char **args, int in_fd, int out_fd, int close_fd){
+    const char *path = lookup_path(args[0], 1);
+    if(use_spawn){
+        if(path == NULL){
+            printf("Invalid Prompt\n");
+            return -1;
+        }
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        if(in_fd != -1){
+            posix_spawn_file_actions_adddup2(&actions, in_fd, STDIN_FILENO);
+            posix_spawn_file_actions_addclose(&actions, in_fd);
+        }
+        if(out_fd != -1){
+            posix_spawn_file_actions_adddup2(&actions, out_fd, STDOUT_FILENO);
+            posix_spawn_file_actions_addclose(&actions, out_fd);
+        }
+        if(close_fd != -1){
+            posix_spawn_file_actions_addclose(&actions, close_fd);
+        }
+        pid_t pid;
+        //a failed exec is reported here, not by a child that exits
+        int err = posix_spawn(&pid, path, &actions, NULL, args, environ);
+        posix_spawn_file_actions_destroy(&actions);
+        if(err != 0){
+            if(err == ENOENT) forget_path(args[0]);
+            printf("Invalid Prompt\n");
+            return -1;
+        }
+        return pid;
+    }
+
+    int err_pipe[2];
+    if (pipe2(err_pipe, O_CLOEXEC) == -1) {
+        perror("Failed to create pipe");
+        exit(1);
+    }
+    int pid = fork();
+    if (pid < 0) {
+        printf("Failed to fork\n");
+        exit(1);
+    } else if (pid == 0) {
+        if(in_fd != -1){
+            dup2(in_fd, STDIN_FILENO);
+            close(in_fd);
+        }
+        if(out_fd != -1){
+            dup2(out_fd, STDOUT_FILENO);
+            close(out_fd);
+        }
+        if(close_fd != -1) close(close_fd);
+        close(err_pipe[0]);
+        exec_resolved(args, path, err_pipe[1]);
+    }
+    close(err_pipe[1]);
+    check_exec(args, err_pipe[0]);
+    return pid;
+}
+
+//launch builtin: "launch" shows how commands are started, "launch fork" or
+//"launch spawn" picks it
+void launch_builtin(char *input){
+    char *args[64];
+    int bg;
+    int n = parse_command(input, args, &bg);
+    if(n > 1 && strcmp(args[1], "fork") == 0){
+        use_spawn = 0;
+    }else if(n > 1 && strcmp(args[1], "spawn") == 0){
+        use_spawn = 1;
+    }else if(n > 1){
+        printf("Use: launch [fork|spawn]\n");
+        return;
+    }
+    printf("Commands are launched with %s\n", use_spawn ? "posix_spawn" : "fork");
+}
+
+int compare_longs(const void *a, const void *b){
+    long x = *(const long *)a, y = *(const long *)b;
+    return (x > y) - (x < y);
+}
+
+#define LAUNCHBENCH_MAX_MB 16384
+#define LAUNCHBENCH_MAX_RUNS 1000000
+
+//launchbench [-m MB] runs command [args...]: time launching the command
+//until it exits, runs times with fork and runs times with posix_spawn, with
+//its output sent to /dev/null. -m first grows the shell's heap by MB to show
+//what fork's copying costs, e.g. after "gcc -o hello HelloWord.c":
+//launchbench -m 256 200 ./hello
+void launchbench_builtin(char *input){
+    char *args[64];
+    int bg;
+    int n = parse_command(input, args, &bg);
+    int first = 1;
+    long heap_mb = 0;
+    if(n > 2 && strcmp(args[1], "-m") == 0){
+        heap_mb = atol(args[2]);
+        first = 3;
+    }
+    int runs = first < n ? atoi(args[first]) : 0;
+    if(runs <= 0 || first + 1 >= n || heap_mb < 0){
+        printf("Use: launchbench [-m MB] runs command [args...]\n");
+        return;
+    }
+    if(heap_mb > LAUNCHBENCH_MAX_MB || runs > LAUNCHBENCH_MAX_RUNS){
+        printf("launchbench: at most %d MB and %d runs\n", LAUNCHBENCH_MAX_MB, LAUNCHBENCH_MAX_RUNS);
+        return;
+    }
+    char **cmd = &args[first + 1];
+
+    //touch every page, so fork has to copy all of their page table entries
+    char *ballast = NULL;
+    if(heap_mb > 0){
+        ballast = malloc(heap_mb << 20);
+        if(ballast == NULL){
+            printf("Could not grow the heap by %ld MB\n", heap_mb);
+            return;
+        }
+        memset(ballast, 1, heap_mb << 20);
+    }
+    long *micros = malloc(runs * sizeof(long));
+    if(micros == NULL){
+        printf("Could not allocate %d timings\n", runs);
+        free(ballast);
+        return;
+    }
+    int devnull = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    int saved = use_spawn;
+    for(int mode = 0; mode < 2; mode++){
+        use_spawn = mode;
+        int done = 0;
+        for(int i = 0; i < runs; i++){
+            struct timeval start, finish;
+            gettimeofday(&start, NULL);
+            int pid = start_process(cmd, -1, devnull, -1);
+            if(pid == -1) break;
+            waitpid(pid, NULL, 0);
+            gettimeofday(&finish, NULL);
+            micros[done++] = (finish.tv_sec - start.tv_sec) * 1000000 + finish.tv_usec - start.tv_usec;
+        }
+        if(done == 0) break;
+        qsort(micros, done, sizeof(long), compare_longs);
+        long sum = 0;
+        for(int i = 0; i < done; i++) sum += micros[i];
+        printf("%-6s %d runs, heap +%ld MB: mean %ld us, p50 %ld us, p99 %ld us\n", mode ? "spawn" : "fork",
+               done, heap_mb, sum / done, micros[(done * 50 + 99) / 100 - 1], micros[(done * 99 + 99) / 100 - 1]);
+    }
+    use_spawn = saved;
+    free(micros);
+    close(devnull);
+    free(ballast);
+}
+
+//hash builtin: "hash" lists the cache, "hash -r" clears it and
+//"hash name..." looks the names up and remembers them
+void hash_builtin(char *input){
+    char *args[64];
+    int bg;
+    int n = parse_command(input, args, &bg);
+    if(n == 1){
+        int empty = 1;
+        for(int i = 0; i < HASH_BUCKETS; i++){
+            for(hashed_path *curr = path_table[i]; curr != NULL; curr = curr->next){
+                if(empty) printf("hits\tcommand\n");
+                empty = 0;
+                printf("%4d\t%s\n", curr->hits, curr->path);
+            }
+        }
+        if(empty) printf("hash: hash table empty\n");
+    }else if(strcmp(args[1], "-r") == 0){
+        clear_path_table();
+    }else{
+        //like bash, a name is searched for again even if it is cached
+        for(int i = 1; i < n; i++){
+            forget_path(args[i]);
+            if(lookup_path(args[i], 0) == NULL){
+                printf("hash: %s: not found\n", args[i]);
+            }
+        }
+    }
+}
+
 //handle termination signal
 void handle_SIGINT(int sig){
     printf("\nShell terminated. Command history:\n");
@@ -161,6 +486,15 @@ void shell_loop() {
         if (strcmp(command, "history\n") == 0) {
             showHistory();
         }
+        else if (strncmp(command, "hash", 4) == 0 && strchr(" \t\n", command[4]) != NULL) {
+            hash_builtin(command);
+        }
+        else if (strncmp(command, "launchbench", 11) == 0 && strchr(" \t\n", command[11]) != NULL) {
+            launchbench_builtin(command);
+        }
+        else if (strncmp(command, "launch", 6) == 0 && strchr(" \t\n", command[6]) != NULL) {
+            launch_builtin(command);
+        }
         else {
             int bg = 0; 
             commands = parse_for_piping(command, &n);
@@ -230,16 +564,11 @@ int create_process_and_run(char **args, int bg, char *com, char *full_com) {
     time_t t = start.tv_sec;
     time = localtime(&t);
     strftime(time_list, sizeof(time_list), "%Y-%m-%d %H:%M:%S", time);
-    
-    int pid = fork();
-    if (pid < 0) {
-        printf("Failed to fork\n");
-        exit(1);
-    } else if (pid == 0) {
-        if (execvp(args[0], args) == -1) {
-            printf("Invalid Prompt\n");
-            exit(1);
-        }
+
+    //the path is resolved in the parent, so PATH is searched once per command
+    int pid = start_process(args, -1, -1, -1);
+    if (pid == -1) {
+        return 0;
     } else {
         if (bg) {
             printf("Process initiated in background with PID: %d\n", pid);
@@ -275,28 +604,18 @@ void piping(char** commands, int n) {
             pipe(pipe_fd);  
         }
 
-        int pid = fork();
-        if (pid == 0) {  
-            if (fd_in != 0) {
-                dup2(fd_in, STDIN_FILENO);  
-                close(fd_in);
-            }
-            if (i != n) {
-                dup2(pipe_fd[1], STDOUT_FILENO);  
-                close(pipe_fd[1]);
-            }
-            parse_command(commands[i], args, &bg);
-            execvp(args[0], args);
-            perror("exec failed");
-            exit(EXIT_FAILURE);
-        } else { 
-            if (!bg) {
-                wait(NULL);  
-            }
-            if (i != n) {
-                close(pipe_fd[1]);  
-                fd_in = pipe_fd[0];  
-            }
+        parse_command(commands[i], args, &bg);
+        //the child reads the previous pipe and writes this one
+        int pid = start_process(args, fd_in != 0 ? fd_in : -1, i != n ? pipe_fd[1] : -1, i != n ? pipe_fd[0] : -1);
+        if (pid != -1 && !bg) {
+            waitpid(pid, NULL, 0);
+        }
+        if (fd_in != 0) {
+            close(fd_in);
+        }
+        if (i != n) {
+            close(pipe_fd[1]);  
+            fd_in = pipe_fd[0];  
         }
     }
 }